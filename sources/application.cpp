@@ -1,35 +1,62 @@
 #include "application.h"
 
 #include <logger.h>
+#include <tracer.h>
 #include <utils/file_utils.h>
+#include <utils/utils.h>
+
+#include <future>
 
 constexpr auto LABEL = "application";
 
+std::optional<Device> findDevice(const FileConfig& fileConfig, const std::string& name) {
+  const auto it = std::find_if(fileConfig.devices.begin(), fileConfig.devices.end(), [&name](const Device& device) { return device.getName() == name; });
+  return it != fileConfig.devices.end() ? std::optional<Device>(*it) : std::nullopt;
+}
+
+template <typename T>
+bool isChanged(const T& v1, const T& v2) {
+  return static_cast<nlohmann::json>(v1) != static_cast<nlohmann::json>(v2);
+}
+
+bool isReopenRequired(const Device& device1, const Device& device2) {
+  return device1.driver != device2.driver || device1.serial != device2.serial || device1.alias != device2.alias || device1.sample_rate != device2.sample_rate || isChanged(device1.gains, device2.gains) ||
+         isChanged(device1.cores, device2.cores) || device1.iq_correction != device2.iq_correction;
+}
+
 Application::Application(nlohmann::json& tmpJson, const ArgConfig& argConfig)
-    : m_reload(false),
+    : m_startTime(getTime()),
+      m_reload(false),
       m_argConfig(argConfig),
       m_tmpJson(tmpJson),
       m_fileJson(m_tmpJson.empty() ? readFromFile(m_argConfig.configFile, static_cast<nlohmann::json>(FileConfig())) : m_tmpJson),
-      m_fileConfig(FileConfig::fromJson(m_fileJson, m_argConfig.enumerateRemote)),
+      m_fileConfig(FileConfig::fromJson(m_fileJson, m_argConfig)),
       m_config(m_argConfig, m_fileConfig),
       m_mqtt(m_config),
-      m_remoteController(m_config, m_mqtt) {
+      m_remoteController(m_config, m_mqtt),
+      m_metricsExporter(m_config, m_remoteController),
+      m_rangeCoordinator(m_config) {
   Logger::configure(m_config.consoleLogLevel(), m_config.fileLogLevel(), m_argConfig.logFileName, m_argConfig.logFileSize, m_argConfig.logFileCount, m_config.isColorLogEnabled());
   Logger::info(LABEL, "{}", colored(GREEN, "{}", "started"));
   Logger::info(LABEL, "config: {}", colored(GREEN, "{}", FileConfig::toPrint(m_fileJson).dump()));
   Logger::info(LABEL, "mqtt: {}", colored(GREEN, "{}", m_config.mqtt()));
 
+  const auto configTime = getTime();
+  std::vector<Device> devices;
   for (const auto& device : m_config.devices()) {
-    try {
-      if (!device.enabled) {
-        Logger::info(LABEL, "device disabled, skipping: {}", colored(GREEN, "{}", device.getName()));
-      } else {
-        m_scanners.push_back(std::make_unique<Scanner>(m_config, device, m_remoteController));
-      }
-    } catch (const std::exception& exception) {
-      Logger::exception(LABEL, exception, SPDLOG_LOC, "open device failed: {}", device.getName());
+    if (!device.enabled) {
+      Logger::info(LABEL, "device disabled, skipping: {}", colored(GREEN, "{}", device.getName()));
+    } else {
+      devices.push_back(device);
     }
   }
+  startScanners(devices);
+  Logger::info(
+      LABEL,
+      "startup time, config: {}, devices: {}, total: {}",
+      colored(GREEN, "{} ms", (configTime - m_startTime).count()),
+      colored(GREEN, "{} ms", (getTime() - configTime).count()),
+      colored(GREEN, "{} ms", (getTime() - m_startTime).count()));
   if (m_scanners.empty()) {
     Logger::warn(LABEL, "{}", colored(RED, "{}", "empty devices list"));
   }
@@ -38,7 +65,8 @@ Application::Application(nlohmann::json& tmpJson, const ArgConfig& argConfig)
     try {
       Logger::info(LABEL, "set config: {}", colored(GREEN, "{}", FileConfig::toPrint(json).dump()));
       saveToFile(m_argConfig.configFile, FileConfig::toSave(json));
-      m_reload = true;
+      std::unique_lock lock(m_mutex);
+      m_pendingJson = json;
       m_tmpJson.clear();
       m_remoteController.setConfigResponse(true);
     } catch (const std::runtime_error& exception) {
@@ -49,7 +77,8 @@ Application::Application(nlohmann::json& tmpJson, const ArgConfig& argConfig)
 
   m_remoteController.resetTmpConfigQuery([this](const std::string&) {
     Logger::info(LABEL, "reset tmp config");
-    m_reload = true;
+    std::unique_lock lock(m_mutex);
+    m_pendingJson = readFromFile(m_argConfig.configFile, static_cast<nlohmann::json>(FileConfig()));
     m_tmpJson.clear();
     m_remoteController.resetTmpConfigResponse(true);
   });
@@ -57,7 +86,8 @@ Application::Application(nlohmann::json& tmpJson, const ArgConfig& argConfig)
   m_remoteController.setTmpConfigQuery([this](const nlohmann::json& json) {
     try {
       Logger::info(LABEL, "set tmp config: {}", colored(GREEN, "{}", FileConfig::toPrint(json).dump()));
-      m_reload = true;
+      std::unique_lock lock(m_mutex);
+      m_pendingJson = json;
       m_tmpJson = json;
       m_remoteController.setConfigResponse(true);
     } catch (const std::runtime_error& exception) {
@@ -66,12 +96,182 @@ Application::Application(nlohmann::json& tmpJson, const ArgConfig& argConfig)
     }
   });
 
+  m_remoteController.setDetectionQuery([this](const nlohmann::json& json) {
+    Logger::info(LABEL, "set detection: {}", colored(GREEN, "{}", json.dump()));
+    std::unique_lock lock(m_mutex);
+    m_pendingDetection = json;
+  });
+
+  m_remoteController.traceDumpQuery([this](const std::string&) {
+    Logger::info(LABEL, "trace dump");
+    dumpTrace();
+    m_remoteController.traceDumpResponse(Tracer::isEnabled());
+  });
+
   m_remoteController.getConfigQuery([this](const std::string&) {
     Logger::info(LABEL, "get config");
-    m_remoteController.getConfigResponse(static_cast<nlohmann::json>(m_fileConfig).dump());
+    std::unique_lock lock(m_mutex);
+    const auto json = static_cast<nlohmann::json>(m_fileConfig);
+    lock.unlock();
+    m_remoteController.getConfigResponse(json.dump());
   });
 }
 
 Application::~Application() { Logger::info(LABEL, "{}", colored(GREEN, "{}", "stopped")); }
 
 bool Application::reload() const { return m_reload; }
+
+void Application::update() {
+  m_rangeCoordinator.update(m_scanners);
+
+  std::unique_lock lock(m_mutex);
+  auto detection = std::move(m_pendingDetection);
+  m_pendingDetection.reset();
+  lock.unlock();
+  if (detection) {
+    try {
+      applyDetection(*detection);
+      m_remoteController.setDetectionResponse(true);
+    } catch (const std::exception& exception) {
+      Logger::exception(LABEL, exception, SPDLOG_LOC, "set detection failed");
+      m_remoteController.setDetectionResponse(false);
+    }
+  }
+
+  lock.lock();
+  if (!m_pendingJson) {
+    return;
+  }
+  const auto json = std::move(*m_pendingJson);
+  m_pendingJson.reset();
+  lock.unlock();
+
+  try {
+    applyConfig(json);
+  } catch (const std::exception& exception) {
+    Logger::exception(LABEL, exception, SPDLOG_LOC, "apply config failed, reloading");
+    m_reload = true;
+  }
+}
+
+void Application::applyConfig(const nlohmann::json& json) {
+  const auto fileConfig = FileConfig::fromJson(json, m_fileConfig);
+  for (const auto& device : fileConfig.devices) {
+    if (device.enabled && !device.connected && !m_scanners.count(device.getName())) {
+      Logger::info(LABEL, "unknown device, reloading: {}", colored(GREEN, "{}", device.getName()));
+      m_reload = true;
+      return;
+    }
+  }
+
+  // source and selector buffers are sized when device is opened
+  const auto isReopenAllRequired = fileConfig.buffer_profile != m_fileConfig.buffer_profile;
+  const auto isRebuildRequired = fileConfig.recording.min_sample_rate != m_fileConfig.recording.min_sample_rate || fileConfig.threads.fft_threads != m_fileConfig.threads.fft_threads ||
+                                 fileConfig.history_precision != m_fileConfig.history_precision;
+  const auto isScheduleChanged = isChanged(fileConfig.position, m_fileConfig.position) || isChanged(fileConfig.scheduler, m_fileConfig.scheduler);
+  const auto isOutputChanged = isChanged(fileConfig.output, m_fileConfig.output);
+  const auto isIgnoredChanged = isChanged(fileConfig.ignored_frequencies, m_fileConfig.ignored_frequencies);
+  m_config.update(fileConfig);
+  if (isOutputChanged) {
+    Logger::configure(m_config.consoleLogLevel(), m_config.fileLogLevel(), m_argConfig.logFileName, m_argConfig.logFileSize, m_argConfig.logFileCount, m_config.isColorLogEnabled());
+  }
+
+  // devices are closed before opening again to release them
+  for (auto it = m_scanners.begin(); it != m_scanners.end();) {
+    const auto previous = findDevice(m_fileConfig, it->first);
+    const auto device = findDevice(fileConfig, it->first);
+    if (!device || !device->enabled || !previous || isReopenAllRequired || isReopenRequired(*previous, *device)) {
+      Logger::info(LABEL, "stopping device: {}", colored(GREEN, "{}", it->first));
+      it = m_scanners.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  std::vector<Device> devices;
+  for (const auto& device : fileConfig.devices) {
+    const auto it = m_scanners.find(device.getName());
+    const auto previous = findDevice(m_fileConfig, device.getName());
+    if (!device.enabled) {
+      continue;
+    } else if (it == m_scanners.end()) {
+      devices.push_back(device);
+    } else {
+      if (isRebuildRequired || isIgnoredChanged || isChanged(previous->ranges, device.ranges)) {
+        Logger::info(LABEL, "updating ranges: {}", colored(GREEN, "{}", device.getName()));
+        it->second->updateRanges(device, isRebuildRequired);
+      }
+      if (isScheduleChanged || isChanged(previous->satellites, device.satellites) || isChanged(previous->crontabs, device.crontabs)) {
+        Logger::info(LABEL, "updating schedule: {}", colored(GREEN, "{}", device.getName()));
+        it->second->updateSchedule(device);
+      }
+    }
+  }
+
+  startScanners(devices);
+  m_rangeCoordinator.invalidate();
+
+  std::unique_lock lock(m_mutex);
+  m_fileConfig = fileConfig;
+  Logger::info(LABEL, "config applied: {}", colored(GREEN, "{}", FileConfig::toPrint(json).dump()));
+}
+
+// updates levels and timeouts read by detection blocks through config snapshot, flowgraphs are not touched
+// expected json: {"recording": {"min_time_ms", "max_noise_time_ms", "step"}, "devices": {"<driver>_<serial>": {"start_recording_level", "stop_recording_level"}}}
+void Application::applyDetection(const nlohmann::json& json) {
+  auto fileConfig = m_fileConfig;
+  if (json.contains("recording")) {
+    const auto& recording = json.at("recording");
+    fileConfig.recording.min_time_ms = recording.value("min_time_ms", fileConfig.recording.min_time_ms);
+    fileConfig.recording.max_noise_time_ms = recording.value("max_noise_time_ms", fileConfig.recording.max_noise_time_ms);
+    fileConfig.recording.step = recording.value("step", fileConfig.recording.step);
+  }
+  if (json.contains("devices")) {
+    for (const auto& [name, levels] : json.at("devices").items()) {
+      const auto it = std::find_if(fileConfig.devices.begin(), fileConfig.devices.end(), [&name](const Device& device) { return device.getName() == name; });
+      if (it == fileConfig.devices.end()) {
+        throw std::runtime_error(fmt::format("unknown device: {}", name));
+      }
+      it->start_recording_level = levels.value("start_recording_level", it->start_recording_level);
+      it->stop_recording_level = levels.value("stop_recording_level", it->stop_recording_level);
+    }
+  }
+  m_config.update(fileConfig);
+
+  std::unique_lock lock(m_mutex);
+  m_fileConfig = fileConfig;
+  Logger::info(LABEL, "detection applied: {}", colored(GREEN, "{}", json.dump()));
+}
+
+void Application::startScanners(const std::vector<Device>& devices) {
+  std::vector<std::future<std::unique_ptr<Scanner>>> scanners;
+  for (const auto& device : devices) {
+    scanners.push_back(std::async(std::launch::async, [this, device]() { return createScanner(device); }));
+  }
+  for (size_t i = 0; i < devices.size(); ++i) {
+    auto scanner = scanners[i].get();
+    if (scanner) {
+      m_scanners[devices[i].getName()] = std::move(scanner);
+    }
+  }
+}
+
+std::unique_ptr<Scanner> Application::createScanner(const Device& device) {
+  try {
+    const auto startTime = getTime();
+    auto scanner = std::make_unique<Scanner>(m_config, device, m_remoteController);
+    Logger::info(LABEL, "device started: {}, time: {}", colored(GREEN, "{}", device.getName()), colored(GREEN, "{} ms", (getTime() - startTime).count()));
+    return scanner;
+  } catch (const std::exception& exception) {
+    Logger::exception(LABEL, exception, SPDLOG_LOC, "open device failed: {}", device.getName());
+    return nullptr;
+  }
+}
+
+void Application::dumpTrace() const {
+  if (!Tracer::isEnabled()) {
+    Logger::warn(LABEL, "tracing disabled, run with --trace");
+    return;
+  }
+  Tracer::dump(fmt::format("{}/trace_{}.json", m_config.workDir(), getTime().count()));
+}
@@ -3,11 +3,18 @@
 #include <arg_config.h>
 #include <config.h>
 #include <file_config.h>
+#include <network/metrics_exporter.h>
 #include <network/mqtt.h>
 #include <network/remote_controller.h>
+#include <range_coordinator.h>
 #include <scanner.h>
 
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
 #include <nlohmann/json.hpp>
+#include <optional>
 
 class Application {
  public:
@@ -15,16 +22,29 @@ class Application {
   ~Application();
 
   bool reload() const;
+  void update();
+  void dumpTrace() const;
 
  private:
-  bool m_reload;
+  void applyConfig(const nlohmann::json& json);
+  void applyDetection(const nlohmann::json& json);
+  void startScanners(const std::vector<Device>& devices);
+  std::unique_ptr<Scanner> createScanner(const Device& device);
+
+  const std::chrono::milliseconds m_startTime;
+  std::atomic<bool> m_reload;
   const ArgConfig& m_argConfig;
   nlohmann::json& m_tmpJson;
   const nlohmann::json m_fileJson;
-  const FileConfig m_fileConfig;
-  const Config m_config;
+  FileConfig m_fileConfig;
+  Config m_config;
 
   Mqtt m_mqtt;
   RemoteController m_remoteController;
-  std::vector<std::unique_ptr<Scanner>> m_scanners;
+  MetricsExporter m_metricsExporter;
+  std::map<std::string, std::unique_ptr<Scanner>> m_scanners;
+  RangeCoordinator m_rangeCoordinator;
+  std::mutex m_mutex;
+  std::optional<nlohmann::json> m_pendingJson;
+  std::optional<nlohmann::json> m_pendingDetection;
 };
\ No newline at end of file
@@ -11,8 +11,14 @@ struct ArgConfig {
   std::string mqttUrl;
   std::string mqttUser;
   std::string mqttPassword;
+  int mqttSpoolSize = 0;                     // disk spool size in MB for broker outages, 0 disables spool
+  int metricsPort = 0;                       // prometheus metrics http port, 0 disables http endpoint
+  std::string metricsAddress = "127.0.0.1";  // prometheus metrics http bind address, 0.0.0.0 exposes it on all interfaces
+  int metricsInterval = 0;                   // publish metrics on mqtt every n seconds, 0 disables publishing
   std::string workDir = ".";
   bool enumerateRemote = false;
+  bool probeDevices = false;  // open devices to read capabilities instead of using cache
   bool dumpSource = false;
   bool dumpRecording = false;
+  bool trace = false;
 };
\ No newline at end of file
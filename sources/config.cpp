@@ -5,6 +5,7 @@
 #include <radio/sdr_device_reader.h>
 #include <utils/utils.h>
 
+#include <algorithm>
 #include <fstream>
 #include <regex>
 
@@ -24,43 +25,115 @@ spdlog::level::level_enum parseLogLevel(const std::string& level) {
   return spdlog::level::level_enum::off;
 }
 
-Config::Config(const ArgConfig& argConfig, const FileConfig& fileConfig) : m_id(!argConfig.id.empty() ? argConfig.id : randomHex(8)), m_argConfig(argConfig), m_fileConfig(fileConfig) {}
+Config::Config(const ArgConfig& argConfig, const FileConfig& fileConfig)
+    : m_id(!argConfig.id.empty() ? argConfig.id : randomHex(8)), m_argConfig(argConfig), m_fileConfig(std::make_shared<const FileConfig>(fileConfig)), m_detectionVersion(0) {
+  updateDetection(fileConfig);
+}
+void Config::update(const FileConfig& fileConfig) {
+  auto newFileConfig = std::make_shared<const FileConfig>(fileConfig);
+  std::unique_lock lock(m_mutex);
+  m_fileConfig.swap(newFileConfig);
+  lock.unlock();
+  updateDetection(fileConfig);
+}
+void Config::updateDetection(const FileConfig& fileConfig) {
+  const auto max_workers = static_cast<int>(std::thread::hardware_concurrency());
+  const auto auto_workers = max_workers / 2;
+  const auto workers = std::max(0, std::min(fileConfig.workers, max_workers));
+
+  auto detection = std::make_shared<DetectionConfigs>();
+  detection->defaults.startLevel = DEFAULT_RECORDING_START_LEVEL;
+  detection->defaults.stopLevel = DEFAULT_RECORDING_STOP_LEVEL;
+  detection->defaults.minTime = fileConfig.recording.min_time_ms;
+  detection->defaults.timeout = fileConfig.recording.max_noise_time_ms;
+  detection->defaults.tuningStep = fileConfig.recording.step;
+  detection->defaults.bandwidth = fileConfig.recording.min_sample_rate;
+  detection->defaults.recordersCount = workers == 0 ? auto_workers : workers;
+  for (const auto& range : fileConfig.ignored_frequencies) {
+    detection->defaults.ignoredRanges.emplace_back(range.frequency - range.bandwidth / 2, range.frequency + range.bandwidth / 2);
+  }
+  for (const auto& device : fileConfig.devices) {
+    auto deviceDetection = std::make_shared<DetectionConfig>(detection->defaults);
+    deviceDetection->startLevel = device.start_recording_level;
+    deviceDetection->stopLevel = device.stop_recording_level;
+    detection->devices[device.getName()] = std::move(deviceDetection);
+  }
+  m_detection.store(std::move(detection));
+  m_detectionVersion.fetch_add(1, std::memory_order_release);
+}
+std::shared_ptr<const FileConfig> Config::fileConfig() const {
+  std::unique_lock lock(m_mutex);
+  return m_fileConfig;
+}
+
 std::string Config::mqtt() const { return fmt::format("{}@{}", m_argConfig.mqttUser, m_argConfig.mqttUrl); };
 
 std::string Config::getId() const { return m_id; }
-std::vector<Device> Config::devices() const { return m_fileConfig.devices; }
+std::vector<Device> Config::devices() const { return fileConfig()->devices; }
 
-bool Config::isColorLogEnabled() const { return m_fileConfig.output.color_log_enabled; }
-spdlog::level::level_enum Config::consoleLogLevel() const { return parseLogLevel(m_fileConfig.output.console_log_level); }
-spdlog::level::level_enum Config::fileLogLevel() const { return parseLogLevel(m_fileConfig.output.file_log_level); }
+bool Config::isColorLogEnabled() const { return fileConfig()->output.color_log_enabled; }
+spdlog::level::level_enum Config::consoleLogLevel() const { return parseLogLevel(fileConfig()->output.console_log_level); }
+spdlog::level::level_enum Config::fileLogLevel() const { return parseLogLevel(fileConfig()->output.file_log_level); }
 
-std::vector<FrequencyRange> Config::ignoredRanges() const {
-  std::vector<FrequencyRange> ranges;
-  for (const auto& range : m_fileConfig.ignored_frequencies) {
-    ranges.emplace_back(range.frequency - range.bandwidth / 2, range.frequency + range.bandwidth / 2);
+std::vector<FrequencyRange> Config::ignoredRanges() const { return m_detection.load()->defaults.ignoredRanges; }
+std::vector<FrequencyRange> Config::pooledRanges() const { return fileConfig()->pooled_ranges; }
+Frequency Config::recordingBandwidth() const { return fileConfig()->recording.min_sample_rate; }
+std::shared_ptr<const DetectionConfig> Config::detection(const Device& device) const {
+  const auto detection = m_detection.load();
+  const auto it = detection->devices.find(device.getName());
+  if (it != detection->devices.end()) {
+    return it->second;
   }
-  return ranges;
+  auto deviceDetection = std::make_shared<DetectionConfig>(detection->defaults);
+  deviceDetection->startLevel = device.start_recording_level;
+  deviceDetection->stopLevel = device.stop_recording_level;
+  return deviceDetection;
 }
-int Config::recordersCount() const {
-  const auto max_workers = static_cast<int>(std::thread::hardware_concurrency());
-  const auto auto_workers = max_workers / 2;
-  const auto workers = std::max(0, std::min(m_fileConfig.workers, max_workers));
-  return workers == 0 ? auto_workers : workers;
-}
-Frequency Config::recordingBandwidth() const { return m_fileConfig.recording.min_sample_rate; }
-std::chrono::milliseconds Config::recordingMinTime() const { return m_fileConfig.recording.min_time_ms; }
-std::chrono::milliseconds Config::recordingTimeout() const { return m_fileConfig.recording.max_noise_time_ms; }
-Frequency Config::recordingTuningStep() const { return m_fileConfig.recording.step; }
+uint64_t Config::detectionVersion() const { return m_detectionVersion.load(std::memory_order_acquire); }
+bool Config::isSigmfSinkEnabled() const { return fileConfig()->recording.sink == "sigmf"; }
+std::string Config::sigmfDir() const { return m_argConfig.workDir + "/recordings"; }
+std::string Config::sigmfFormat() const { return fileConfig()->recording.sigmf.format == "ci8" ? "ci8" : "ci16"; }
+uint64_t Config::sigmfMaxFileSize() const { return static_cast<uint64_t>(std::max(1, fileConfig()->recording.sigmf.max_file_size_mb)) * 1024 * 1024; }
+uint64_t Config::sigmfMaxTotalSize() const { return static_cast<uint64_t>(std::max(1, fileConfig()->recording.sigmf.max_total_size_mb)) * 1024 * 1024; }
 
 std::string Config::mqttUrl() const { return m_argConfig.mqttUrl; }
 std::string Config::mqttUsername() const { return m_argConfig.mqttUser; }
 std::string Config::mqttPassword() const { return m_argConfig.mqttPassword; }
+int Config::mqttSpoolSize() const { return m_argConfig.mqttSpoolSize; }
+
+std::vector<int> Config::recorderCores() const { return fileConfig()->threads.recorder_cores; }
+int Config::sourcePriority() const { return fileConfig()->threads.source_priority; }
+int Config::fftThreads() const { return fileConfig()->threads.fft_threads; }
+std::string Config::bufferProfile() const { return fileConfig()->buffer_profile; }
+std::string Config::historyPrecision() const { return fileConfig()->history_precision; }
 
-std::string Config::latitude() const { return m_fileConfig.position.latitude; }
-std::string Config::longitude() const { return m_fileConfig.position.longitude; }
-int Config::altitude() const { return m_fileConfig.position.altitude; }
+int Config::metricsPort() const { return m_argConfig.metricsPort; }
+std::string Config::metricsAddress() const { return m_argConfig.metricsAddress; }
+std::chrono::seconds Config::metricsInterval() const { return std::chrono::seconds(m_argConfig.metricsInterval); }
+
+std::string Config::latitude() const { return fileConfig()->position.latitude; }
+std::string Config::longitude() const { return fileConfig()->position.longitude; }
+int Config::altitude() const { return fileConfig()->position.altitude; }
+bool Config::isLocalSchedulerEnabled() const { return fileConfig()->scheduler.mode == "local"; }
+std::string Config::tleFile() const {
+  const auto file = fileConfig()->scheduler.tle_file;
+  return file.starts_with("/") ? file : m_argConfig.workDir + "/" + file;
+}
+double Config::minElevation() const { return fileConfig()->scheduler.min_elevation; }
 
 std::string Config::workDir() const { return m_argConfig.workDir; }
 
 bool Config::dumpSource() const { return m_argConfig.dumpSource; }
 bool Config::dumpRecording() const { return m_argConfig.dumpRecording; }
+
+DetectionSnapshot::DetectionSnapshot(const Config& config, const Device& device) : m_config(config), m_device(device), m_version(config.detectionVersion()), m_detection(config.detection(device)) {}
+
+void DetectionSnapshot::refresh() {
+  const auto version = m_config.detectionVersion();
+  if (version != m_version) {
+    m_version = version;
+    m_detection = m_config.detection(m_device);
+  }
+}
+
+const DetectionConfig& DetectionSnapshot::get() const { return *m_detection; }
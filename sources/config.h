@@ -5,19 +5,26 @@
 #include <logger.h>
 #include <radio/help_structures.h>
 
+#include <atomic>
 #include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
 
 // INTERNAL SETTINGS
 constexpr auto INITIAL_DELAY = std::chrono::milliseconds(1000);           // delay after first start sdr device to start processing
-constexpr auto PERFORMANCE_LOGGER_INTERVAL = 1000;                        // print stats every n frames
+constexpr auto LATENCY_REPORT_INTERVAL = std::chrono::seconds(60);        // print blocks latency percentiles every n
 constexpr auto RECORDER_FLUSH_INTERVAL = std::chrono::milliseconds(100);  // flush recordings to mqtt every 2 * n bytes
 constexpr auto TRANSMISSION_MAX_TIME = std::chrono::minutes(10);          // break transmission if longer that
 
 // SCANNING SETTINGS
 constexpr auto NOISE_LEARNING_TIME = std::chrono::milliseconds(2000);  // noise learnig time
 constexpr auto RANGE_SCANNING_TIME = std::chrono::milliseconds(500);   // waiting time for transmission in single scanning range
+constexpr auto RANGE_REBALANCE_INTERVAL = std::chrono::seconds(60);    // reassign pooled ranges between devices every n
+constexpr auto RANGE_DC_GUARD = 25000;                                 // keep tuned frequency n Hz away from scanned ranges if possible
+constexpr auto IQ_CORRECTION_TIME = std::chrono::milliseconds(100);    // dc and iq imbalance estimation time constant
 
 // SIGNAL DETECTION SETTINGS
 constexpr auto GROUPING_X = 21;                    // average n frames in frequency domain
@@ -31,6 +38,7 @@ constexpr auto SIGNAL_DETECTION_MAX_STEP = 250;    // max step after fft
 constexpr auto SPECTROGRAM_PREFERRED_MAX_STEP = 1000;                        // spectrogram preferred max step
 constexpr auto SPECTROGRAM_MAX_FFT = 16384;                                  // spectrogram fft limit
 constexpr auto SPECTROGRAM_SEND_INTERVAL = std::chrono::milliseconds(1000);  // send spectrogram data interval
+constexpr auto SPECTROGRAM_LEASE_TIME = std::chrono::seconds(60);            // process spectrogram n time after last subscribe message
 
 // RECORDER SETTINGS
 constexpr auto RECORDER_SAMPLE_RATE_DECIMATOR = 2000000;
@@ -40,10 +48,29 @@ constexpr auto GAIN_TESTER_SOURCE_NAME = "gain tester";
 constexpr auto GAIN_TESTER_RECORDING_NAME = "auto";
 constexpr auto SCANNER_SOURCE_NAME = "scanner";
 constexpr auto SCANNER_RECORDING_NAME = "auto";
+constexpr auto SATELLITE_SOURCE_NAME = "satellite";
+constexpr auto CRONTAB_SOURCE_NAME = "crontab";
+
+// detection parameters of single device, immutable snapshot replaced as whole on config update
+struct DetectionConfig {
+  float startLevel;
+  float stopLevel;
+  std::chrono::milliseconds minTime;
+  std::chrono::milliseconds timeout;
+  Frequency tuningStep;
+  Frequency bandwidth;
+  int recordersCount;
+  std::vector<FrequencyRange> ignoredRanges;
+};
 
 class Config {
  public:
   Config(const ArgConfig& argConfig, const FileConfig& fileConfig);
+  Config(const Config&) = delete;
+  Config& operator=(const Config&) = delete;
+
+  // replaces file config, getters return new values from next call
+  void update(const FileConfig& fileConfig);
   std::string mqtt() const;
 
   std::string getId() const;
@@ -54,26 +81,72 @@ class Config {
   spdlog::level::level_enum fileLogLevel() const;
 
   std::vector<FrequencyRange> ignoredRanges() const;
-  int recordersCount() const;
+  std::vector<FrequencyRange> pooledRanges() const;
   Frequency recordingBandwidth() const;
-  std::chrono::milliseconds recordingMinTime() const;
-  std::chrono::milliseconds recordingTimeout() const;
-  Frequency recordingTuningStep() const;
+  // lock-free, returned snapshot stays valid and unchanged, new one is published with incremented version
+  std::shared_ptr<const DetectionConfig> detection(const Device& device) const;
+  uint64_t detectionVersion() const;
+  bool isSigmfSinkEnabled() const;
+  std::string sigmfDir() const;
+  std::string sigmfFormat() const;
+  uint64_t sigmfMaxFileSize() const;
+  uint64_t sigmfMaxTotalSize() const;
 
   std::string mqttUrl() const;
   std::string mqttUsername() const;
   std::string mqttPassword() const;
+  int mqttSpoolSize() const;
+
+  std::vector<int> recorderCores() const;
+  int sourcePriority() const;
+  int fftThreads() const;
+  std::string bufferProfile() const;
+  std::string historyPrecision() const;
+
+  int metricsPort() const;
+  std::string metricsAddress() const;
+  std::chrono::seconds metricsInterval() const;
 
   std::string latitude() const;
   std::string longitude() const;
   int altitude() const;
+  bool isLocalSchedulerEnabled() const;
+  std::string tleFile() const;
+  double minElevation() const;
 
   std::string workDir() const;
   bool dumpSource() const;
   bool dumpRecording() const;
 
  private:
+  struct DetectionConfigs {
+    DetectionConfig defaults;
+    std::map<std::string, std::shared_ptr<const DetectionConfig>> devices;
+  };
+
+  std::shared_ptr<const FileConfig> fileConfig() const;
+  void updateDetection(const FileConfig& fileConfig);
+
   const std::string m_id;
   const ArgConfig& m_argConfig;
-  const FileConfig& m_fileConfig;
+  mutable std::mutex m_mutex;
+  std::shared_ptr<const FileConfig> m_fileConfig;
+  std::atomic<std::shared_ptr<const DetectionConfigs>> m_detection;
+  std::atomic<uint64_t> m_detectionVersion;
+};
+
+// reader side cache of device detection config, not thread safe, one per reader
+class DetectionSnapshot {
+ public:
+  DetectionSnapshot(const Config& config, const Device& device);
+
+  // checks version with single atomic load and reloads snapshot only after update, invalidates references from get
+  void refresh();
+  const DetectionConfig& get() const;
+
+ private:
+  const Config& m_config;
+  const Device& m_device;
+  uint64_t m_version;
+  std::shared_ptr<const DetectionConfig> m_detection;
 };
@@ -3,15 +3,84 @@
 #include <config_migrator.h>
 #include <logger.h>
 #include <radio/sdr_device_reader.h>
+#include <sched.h>
+#include <utils/thread_utils.h>
 
+#include <map>
 #include <regex>
 
 constexpr auto LABEL = "file_config";
+constexpr auto DEVICES_CACHE_FILE = "devices_cache.json";
 
-FileConfig FileConfig::fromJson(nlohmann::json json, bool enumerateRemote) {
+namespace {
+
+// drops cores missing on this machine, cpu set macros are undefined for them
+void validateCores(std::vector<int>& cores, const std::string& name) {
+  std::erase_if(cores, [&name](const int core) {
+    if (!isValidCore(core)) {
+      Logger::warn(LABEL, "invalid core ignored: {}, {}", core, name);
+      return true;
+    }
+    return false;
+  });
+}
+
+void validateThreads(FileConfig& fileConfig) {
+  const auto maxPriority = sched_get_priority_max(SCHED_FIFO);
+  if (fileConfig.threads.source_priority < 0 || maxPriority < fileConfig.threads.source_priority) {
+    Logger::warn(LABEL, "invalid source priority ignored: {}, max: {}", fileConfig.threads.source_priority, maxPriority);
+    fileConfig.threads.source_priority = 0;
+  }
+  validateCores(fileConfig.threads.recorder_cores, "recorder cores");
+  for (auto& device : fileConfig.devices) {
+    validateCores(device.cores, device.getName());
+  }
+}
+
+// devices may share serial, e.g. not programmed dongles, so n-th device with same driver and serial takes n-th current one
+// driver is missing in saved configs, serial alone is compared then
+const Device* findCurrentDevice(const std::vector<Device>& devices, const Device& device, int occurrence) {
+  for (const auto& current : devices) {
+    if ((device.driver.empty() || current.driver == device.driver) && current.serial == device.serial && occurrence-- == 0) {
+      return &current;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+FileConfig FileConfig::fromJson(nlohmann::json json, const ArgConfig& argConfig) {
+  ConfigMigrator::update(json);
+  FileConfig fileConfig(json);
+  SdrDeviceReader::updateDevices(fileConfig.devices, argConfig.enumerateRemote, argConfig.workDir + "/" + DEVICES_CACHE_FILE, argConfig.probeDevices);
+  validateThreads(fileConfig);
+  return fileConfig;
+}
+
+FileConfig FileConfig::fromJson(nlohmann::json json, const FileConfig& current) {
   ConfigMigrator::update(json);
   FileConfig fileConfig(json);
-  SdrDeviceReader::updateDevices(fileConfig.devices, enumerateRemote);
+  std::map<std::pair<std::string, std::string>, int> occurrences;
+  for (auto& device : fileConfig.devices) {
+    const auto it = findCurrentDevice(current.devices, device, occurrences[{device.driver, device.serial}]++);
+    if (!it) {
+      continue;
+    }
+    device.connected = it->connected;
+    device.driver = it->driver;
+    device.sample_rates = it->sample_rates;
+    const auto values = device.gains;
+    device.gains = it->gains;
+    for (auto& gain : device.gains) {
+      for (const auto& value : values) {
+        if (gain.name == value.name) {
+          gain.value = value.value;
+        }
+      }
+    }
+  }
+  validateThreads(fileConfig);
   return fileConfig;
 }
 
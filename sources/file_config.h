@@ -1,5 +1,6 @@
 #pragma once
 
+#include <arg_config.h>
 #include <radio/help_structures.h>
 #include <utils/serializers.h>
 
@@ -26,13 +27,36 @@ struct PositionConfig {
 };
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PositionConfig, latitude, longitude, altitude)
 
+struct SigmfConfig {
+  std::string format = "ci16";   // ci8, ci16
+  int max_file_size_mb = 512;    // rotate data file if bigger than
+  int max_total_size_mb = 8192;  // remove oldest recordings if directory bigger than
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(SigmfConfig, format, max_file_size_mb, max_total_size_mb)
+
 struct RecordingConfig {
   Frequency min_sample_rate = 32000;
   std::chrono::milliseconds min_time_ms = std::chrono::milliseconds(2000);
   std::chrono::milliseconds max_noise_time_ms = std::chrono::milliseconds(2000);
   Frequency step = 2500;
+  std::string sink = "mqtt";  // mqtt, sigmf
+  SigmfConfig sigmf;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(RecordingConfig, min_sample_rate, min_time_ms, max_noise_time_ms, step, sink, sigmf)
+
+struct ThreadsConfig {
+  std::vector<int> recorder_cores;  // pin recorders to cores, empty disables pinning
+  int source_priority = 10;         // SCHED_FIFO priority of device source thread if permitted, 0 disables
+  int fft_threads = 1;              // fftw threads of each detection fft
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(ThreadsConfig, recorder_cores, source_priority, fft_threads)
+
+struct SchedulerConfig {
+  std::string mode = "remote";       // remote, local
+  std::string tle_file = "tle.txt";  // satellite elements for local mode, relative to work dir
+  int min_elevation = 10;            // degrees, local mode passes below are skipped
 };
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(RecordingConfig, min_sample_rate, min_time_ms, max_noise_time_ms, step)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(SchedulerConfig, mode, tle_file, min_elevation)
 
 struct FileConfig {
   std::vector<Device> devices;
@@ -40,11 +64,18 @@ struct FileConfig {
   OutputConfig output;
   PositionConfig position;
   RecordingConfig recording;
+  ThreadsConfig threads;
+  SchedulerConfig scheduler;
+  std::vector<FrequencyRange> pooled_ranges;  // ranges shared by devices with pooled flag
+  std::string buffer_profile = "default";     // default, latency, throughput
+  std::string history_precision = "float32";  // detection history storage, float32, float16, int16 (0.25 dB), int8 (0.5 dB)
   int version = 1;
   int workers = 0;
 
-  static FileConfig fromJson(nlohmann::json json, bool enumerateRemote);
+  static FileConfig fromJson(nlohmann::json json, const ArgConfig& argConfig);
+  // parses without opening devices, capabilities are copied from current config
+  static FileConfig fromJson(nlohmann::json json, const FileConfig& current);
   static nlohmann::json toSave(nlohmann::json json);
   static nlohmann::json toPrint(nlohmann::json json);
 };
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(FileConfig, devices, ignored_frequencies, output, position, recording, version, workers)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(FileConfig, devices, ignored_frequencies, output, position, recording, threads, scheduler, pooled_ranges, buffer_profile, history_precision, version, workers)
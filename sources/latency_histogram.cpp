@@ -0,0 +1,59 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <vector>
+
+LatencyHistogram::LatencyHistogram() : m_max(0) {
+  for (auto& count : m_counts) {
+    count = 0;
+  }
+}
+
+void LatencyHistogram::record(uint64_t value) {
+  m_counts[toIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  auto max = m_max.load(std::memory_order_relaxed);
+  while (max < value && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot(bool reset) {
+  std::vector<uint64_t> counts(BUCKETS_COUNT);
+  uint64_t total = 0;
+  for (int i = 0; i < BUCKETS_COUNT; ++i) {
+    counts[i] = reset ? m_counts[i].exchange(0, std::memory_order_relaxed) : m_counts[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  const auto max = reset ? m_max.exchange(0, std::memory_order_relaxed) : m_max.load(std::memory_order_relaxed);
+
+  const auto percentile = [&counts, total](double percent) -> uint64_t {
+    const auto threshold = static_cast<uint64_t>(std::ceil(total * percent / 100.0));
+    uint64_t sum = 0;
+    for (int i = 0; i < BUCKETS_COUNT; ++i) {
+      sum += counts[i];
+      if (0 < sum && threshold <= sum) {
+        return toValue(i);
+      }
+    }
+    return 0;
+  };
+  return {total, std::min(max, percentile(50.0)), std::min(max, percentile(99.0)), std::min(max, percentile(99.9)), max};
+}
+
+int LatencyHistogram::toIndex(uint64_t value) {
+  if (value < 2 * SUB_BUCKET_COUNT) {
+    return value;
+  }
+  const auto shift = std::bit_width(value) - 1 - SUB_BUCKET_BITS;
+  return (shift + 1) * SUB_BUCKET_COUNT + (value >> shift) - SUB_BUCKET_COUNT;
+}
+
+uint64_t LatencyHistogram::toValue(int index) {
+  if (index < static_cast<int>(2 * SUB_BUCKET_COUNT)) {
+    return index;
+  }
+  const auto shift = index / SUB_BUCKET_COUNT - 1;
+  const auto subBucket = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+  return ((subBucket + 1) << shift) - 1;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// hdr style log-linear histogram of nanosecond latencies, ~3% precision over full uint64 range
+// record is lock free and wait free (except max), snapshot can be taken from any thread
+class LatencyHistogram {
+  static constexpr int SUB_BUCKET_BITS = 5;
+  static constexpr uint64_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+  static constexpr int BUCKETS_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+ public:
+  struct Snapshot {
+    uint64_t count;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+  };
+
+  LatencyHistogram();
+
+  void record(uint64_t value);
+  Snapshot snapshot(bool reset);
+
+  static int toIndex(uint64_t value);
+  static uint64_t toValue(int index);  // highest value stored in bucket
+
+ private:
+  std::array<std::atomic<uint64_t>, BUCKETS_COUNT> m_counts;
+  std::atomic<uint64_t> m_max;
+};
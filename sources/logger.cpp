@@ -1,32 +1,52 @@
 #include "logger.h"
 
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include <mutex>
+
+constexpr auto ASYNC_QUEUE_SIZE = 16384;  // preallocated log messages, oldest are overwritten when full so callers never block
+
+namespace {
+
+// logger is created once, other threads keep logging through it while levels change
+std::mutex configureMutex;
+std::shared_ptr<spdlog::sinks::sink> consoleSink;
+std::shared_ptr<spdlog::sinks::sink> fileSink;
+
+}  // namespace
+
 void Logger::Logger::configure(
     const spdlog::level::level_enum logLevelConsole, const spdlog::level::level_enum logLevelFile, const std::string& logFile, int fileSize, int filesCount, bool isColorLogEnabled) {
-  std::shared_ptr<spdlog::logger> logger = std::make_shared<spdlog::logger>("auto_sdr");
-
-  if (logLevelConsole != spdlog::level::off) {
-    auto consoleLogger = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-    consoleLogger->set_level(logLevelConsole);
-    logger->sinks().push_back(consoleLogger);
+  std::lock_guard<std::mutex> lock(configureMutex);
+  if (!consoleSink) {
+    if (!spdlog::thread_pool()) {
+      spdlog::init_thread_pool(ASYNC_QUEUE_SIZE, 1);
+    }
+    std::shared_ptr<spdlog::logger> logger = std::make_shared<spdlog::async_logger>("auto_sdr", spdlog::sinks_init_list{}, spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+    consoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    logger->sinks().push_back(consoleSink);
+    // file sink is kept even if disabled, so file logging can be enabled by config change
+    if (!logFile.empty() && 0 < fileSize && 0 < filesCount) {
+      fileSink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(logFile, fileSize, filesCount);
+      logger->sinks().push_back(fileSink);
+    }
+    logger->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%-7l] %v");
+    spdlog::flush_every(std::chrono::seconds(30));
+    spdlog::flush_on(spdlog::level::warn);
+    spdlog::set_default_logger(logger);
   }
 
-  if (logLevelFile != spdlog::level::off && !logFile.empty() && 0 < fileSize && 0 < filesCount) {
-    auto fileLogger = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(logFile, fileSize, filesCount);
-    fileLogger->set_level(logLevelFile);
-    logger->sinks().push_back(fileLogger);
+  // sink and logger levels are atomic, safe while other threads log
+  consoleSink->set_level(logLevelConsole);
+  if (fileSink) {
+    fileSink->set_level(logLevelFile);
   }
-
-  isColorLogEnabled = isColorLogEnabled;
-  logger->set_level(std::min(logLevelConsole, logLevelFile));
-  logger->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%-7l] %v");
-  spdlog::flush_every(std::chrono::seconds(30));
-  spdlog::flush_on(spdlog::level::warn);
-  spdlog::set_default_logger(logger);
+  _isColorLogEnabled = isColorLogEnabled;
+  spdlog::default_logger_raw()->set_level(fileSink ? std::min(logLevelConsole, logLevelFile) : logLevelConsole);
 }
 
 bool Logger::isColorLogEnabled() { return _isColorLogEnabled; }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #define FMT_HEADER_ONLY
 #include <spdlog/spdlog.h>
 
+#include <atomic>
+
 constexpr auto RED = "\033[0;31m";
 constexpr auto GREEN = "\033[0;32m";
 constexpr auto BROWN = "\033[0;33m";
@@ -12,6 +14,13 @@ constexpr auto YELLOW = "\033[0;93m";
 constexpr auto BLUE = "\033[0;94m";
 constexpr auto NC = "\033[0m";
 
+// defined by cmake for debug builds
+#ifdef __DEBUG__
+constexpr auto IS_TRACE_LOG_ENABLED = true;
+#else
+constexpr auto IS_TRACE_LOG_ENABLED = false;  // trace logs are compiled out from release builds
+#endif
+
 #define SPDLOG_LOC \
   spdlog::source_loc { __FILE__, __LINE__, SPDLOG_FUNCTION }
 
@@ -27,48 +36,74 @@ class Logger {
   ~Logger() = delete;
 
  public:
+  // first call creates logger, next calls only change levels and colors so running threads keep valid logger
   static void configure(
       const spdlog::level::level_enum logLevelConsole, const spdlog::level::level_enum logLevelFile, const std::string& logFile, int fileSize, int filesCount, bool isColorLogEnabled);
   static bool isColorLogEnabled();
 
+  // use to skip building expensive log arguments
+  static bool isEnabled(const spdlog::level::level_enum level) { return (level != spdlog::level::trace || IS_TRACE_LOG_ENABLED) && spdlog::should_log(level); }
+
   template <typename... Args>
-  static void trace(const char* label, fmt::format_string<Args...> fmt, Args&&... args) {
-    auto msg = fmt::format(fmt, std::forward<Args>(args)...);
-    spdlog::trace("[{:12}] {}", label, msg);
+  static void trace([[maybe_unused]] const char* label, [[maybe_unused]] fmt::format_string<Args...> fmt, [[maybe_unused]] Args&&... args) {
+    if constexpr (IS_TRACE_LOG_ENABLED) {
+      if (spdlog::should_log(spdlog::level::trace)) {
+        auto msg = fmt::format(fmt, std::forward<Args>(args)...);
+        spdlog::trace("[{:12}] {}", label, msg);
+      }
+    }
   }
 
   template <typename... Args>
   static void debug(const char* label, fmt::format_string<Args...> fmt, Args&&... args) {
+    if (!spdlog::should_log(spdlog::level::debug)) {
+      return;
+    }
     auto msg = fmt::format(fmt, std::forward<Args>(args)...);
     spdlog::debug("[{:12}] {}", label, msg);
   }
 
   template <typename... Args>
   static void info(const char* label, fmt::format_string<Args...> fmt, Args&&... args) {
+    if (!spdlog::should_log(spdlog::level::info)) {
+      return;
+    }
     auto msg = fmt::format(fmt, std::forward<Args>(args)...);
     spdlog::info("[{:12}] {}", label, msg);
   }
 
   template <typename... Args>
   static void warn(const char* label, fmt::format_string<Args...> fmt, Args&&... args) {
+    if (!spdlog::should_log(spdlog::level::warn)) {
+      return;
+    }
     auto msg = fmt::format(fmt, std::forward<Args>(args)...);
     spdlog::warn("[{:12}] {}", label, msg);
   }
 
   template <typename... Args>
   static void error(const char* label, fmt::format_string<Args...> fmt, Args&&... args) {
+    if (!spdlog::should_log(spdlog::level::err)) {
+      return;
+    }
     auto msg = fmt::format(fmt, std::forward<Args>(args)...);
     spdlog::error("[{:12}] {}", label, msg);
   }
 
   template <typename... Args>
   static void critical(const char* label, fmt::format_string<Args...> fmt, Args&&... args) {
+    if (!spdlog::should_log(spdlog::level::critical)) {
+      return;
+    }
     auto msg = fmt::format(fmt, std::forward<Args>(args)...);
     spdlog::critical("[{:12}] {}", label, msg);
   }
 
   template <typename... Args>
   static void exception(const char* label, const std::exception& exception, const spdlog::source_loc& loc, fmt::format_string<Args...> fmt, Args&&... args) {
+    if (!spdlog::should_log(spdlog::level::warn)) {
+      return;
+    }
     auto msg = fmt::format(fmt, std::forward<Args>(args)...);
 #ifdef __DEBUG__
     spdlog::warn("[{:12}] {}, exception: {}, {}, {}", label, colored(RED, "{}", msg), exception.what(), loc.filename, loc.line);
@@ -78,7 +113,7 @@ class Logger {
 #endif
   }
 
-  inline static bool _isColorLogEnabled = true;
+  inline static std::atomic<bool> _isColorLogEnabled = true;
 };
 
 template <typename... Args>
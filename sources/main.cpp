@@ -2,6 +2,7 @@
 #include <application.h>
 #include <logger.h>
 #include <signal.h>
+#include <tracer.h>
 
 #include <CLI/CLI.hpp>
 #include <memory>
@@ -10,12 +11,15 @@
 constexpr auto LABEL = "main";
 
 volatile bool isRunning{true};
+volatile bool isTraceDumpRequested{false};
 
 void handler(int) {
   Logger::warn(LABEL, "{}", colored(RED, "{}", "received stop signal"));
   isRunning = false;
 }
 
+void traceHandler(int) { isTraceDumpRequested = true; }
+
 int main(int argc, char** argv) {
   CLI::App app("sdr-scanner");
   argv = app.ensure_utf8(argv);
@@ -29,24 +33,37 @@ int main(int argc, char** argv) {
   app.add_option("--mqtt-url", argConfig.mqttUrl, "mqtt url")->required();
   app.add_option("--mqtt-user", argConfig.mqttUser, "mqtt username")->required();
   app.add_option("--mqtt-password", argConfig.mqttPassword, "mqtt password")->required();
+  app.add_option("--mqtt-spool-size", argConfig.mqttSpoolSize, "mqtt disk spool size in MB, 0 disabled")->check(CLI::NonNegativeNumber);
+  app.add_option("--metrics-port", argConfig.metricsPort, "prometheus metrics http port, 0 disabled")->check(CLI::Range(0, 65535));
+  app.add_option("--metrics-address", argConfig.metricsAddress, "prometheus metrics http bind address")->check(CLI::ValidIPV4);
+  app.add_option("--metrics-interval", argConfig.metricsInterval, "publish metrics on mqtt every n seconds, 0 disabled")->check(CLI::NonNegativeNumber);
   app.add_option("--work-dir", argConfig.workDir, "work directory");
   app.add_option("--remote", argConfig.enumerateRemote, "enable remote device enumeration");
+  app.add_option("--probe-devices", argConfig.probeDevices, "read devices capabilities again instead of using cache");
   app.add_option("--dump-source", argConfig.dumpSource, "dump source raw IQ");
   app.add_option("--dump-recording", argConfig.dumpRecording, "dump recording raw IQ");
+  app.add_option("--trace", argConfig.trace, "enable event tracing, dump with SIGUSR1 or mqtt command");
   CLI11_PARSE(app, argc, argv);
 
   dup2(fileno(fopen("/dev/null", "w")), fileno(stderr));
   SoapySDR_setLogLevel(SoapySDRLogLevel::SOAPY_SDR_WARNING);
   signal(SIGINT, handler);
   signal(SIGTERM, handler);
+  signal(SIGUSR1, traceHandler);
 
   try {
     Logger::configure(spdlog::level::info, spdlog::level::info, argConfig.logFileName, argConfig.logFileSize, argConfig.logFileCount, true);
     Logger::info(LABEL, "{}", colored(GREEN, "{}", "started"));
+    Tracer::setEnabled(argConfig.trace);
     nlohmann::json tmpJson;
     while (isRunning) {
       Application application(tmpJson, argConfig);
       while (isRunning && !application.reload()) {
+        application.update();
+        if (isTraceDumpRequested) {
+          isTraceDumpRequested = false;
+          application.dumpTrace();
+        }
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
       }
     }
@@ -54,5 +71,6 @@ int main(int argc, char** argv) {
   } catch (const std::exception& exception) {
     Logger::exception(LABEL, exception, SPDLOG_LOC, "crash");
   }
+  spdlog::shutdown();
   return 0;
 }
@@ -0,0 +1,145 @@
+#include "metrics.h"
+
+#include <logger.h>
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+namespace {
+template <typename T>
+struct Family {
+  std::string help;
+  std::map<std::string, std::unique_ptr<T>> metrics;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::set<std::string> names;
+  std::map<std::string, Family<Counter>> counters;
+  std::map<std::string, Family<Gauge>> gauges;
+  std::map<std::string, Family<Histogram>> histograms;
+};
+
+Registry& registry() {
+  static Registry registry;
+  return registry;
+}
+
+std::string escape(const std::string& value) {
+  std::string out;
+  out.reserve(value.size());
+  for (const auto c : value) {
+    if (c == '\\' || c == '"') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+std::string formatLabels(const MetricLabels& labels) {
+  std::string out;
+  for (const auto& [key, value] : labels) {
+    out += fmt::format("{}{}=\"{}\"", out.empty() ? "" : ",", key, escape(value));
+  }
+  return out;
+}
+
+std::string withLabel(const std::string& labels, const std::string& label) { return fmt::format("{{{}{}{}}}", labels, labels.empty() ? "" : ",", label); }
+
+std::string withLabels(const std::string& labels) { return labels.empty() ? "" : fmt::format("{{{}}}", labels); }
+
+template <typename T, typename... Args>
+T& getOrCreate(std::map<std::string, Family<T>>& families, const std::string& name, const std::string& help, const MetricLabels& labels, Args&&... args) {
+  auto& registry = ::registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto it = families.find(name);
+  if (it == families.end()) {
+    if (!registry.names.insert(name).second) {
+      throw std::runtime_error(fmt::format("metric registered with different type: {}", name));
+    }
+    it = families.emplace(name, Family<T>{help, {}}).first;
+  }
+  auto& metric = it->second.metrics[formatLabels(labels)];
+  if (!metric) {
+    metric = std::make_unique<T>(std::forward<Args>(args)...);
+  }
+  return *metric;
+}
+}  // namespace
+
+Histogram::Histogram(const std::vector<double>& buckets) : m_buckets(buckets), m_counts(new std::atomic<uint64_t>[buckets.size() + 1]), m_count(0), m_sum(0.0) {
+  for (size_t i = 0; i <= m_buckets.size(); ++i) {
+    m_counts[i] = 0;
+  }
+}
+
+void Histogram::observe(double value) {
+  const auto index = std::lower_bound(m_buckets.begin(), m_buckets.end(), value) - m_buckets.begin();
+  m_counts[index].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+std::vector<double> Histogram::buckets() const { return m_buckets; }
+
+std::vector<uint64_t> Histogram::cumulativeCounts() const {
+  std::vector<uint64_t> counts(m_buckets.size() + 1);
+  uint64_t sum = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    sum += m_counts[i].load(std::memory_order_relaxed);
+    counts[i] = sum;
+  }
+  return counts;
+}
+
+uint64_t Histogram::count() const { return m_count.load(std::memory_order_relaxed); }
+
+double Histogram::sum() const { return m_sum.load(std::memory_order_relaxed); }
+
+Counter& Metrics::counter(const std::string& name, const std::string& help, const MetricLabels& labels) { return getOrCreate(registry().counters, name, help, labels); }
+
+Gauge& Metrics::gauge(const std::string& name, const std::string& help, const MetricLabels& labels) { return getOrCreate(registry().gauges, name, help, labels); }
+
+Histogram& Metrics::histogram(const std::string& name, const std::string& help, const MetricLabels& labels, const std::vector<double>& buckets) {
+  return getOrCreate(registry().histograms, name, help, labels, buckets);
+}
+
+std::vector<double> Metrics::defaultBuckets() { return {0.00001, 0.00005, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0}; }
+
+std::string Metrics::serialize() {
+  auto& registry = ::registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::string out;
+  for (const auto& [name, family] : registry.counters) {
+    out += fmt::format("# HELP {} {}\n# TYPE {} counter\n", name, family.help, name);
+    for (const auto& [labels, counter] : family.metrics) {
+      out += fmt::format("{}{} {}\n", name, withLabels(labels), counter->value());
+    }
+  }
+  for (const auto& [name, family] : registry.gauges) {
+    out += fmt::format("# HELP {} {}\n# TYPE {} gauge\n", name, family.help, name);
+    for (const auto& [labels, gauge] : family.metrics) {
+      out += fmt::format("{}{} {}\n", name, withLabels(labels), gauge->value());
+    }
+  }
+  for (const auto& [name, family] : registry.histograms) {
+    out += fmt::format("# HELP {} {}\n# TYPE {} histogram\n", name, family.help, name);
+    for (const auto& [labels, histogram] : family.metrics) {
+      const auto buckets = histogram->buckets();
+      const auto counts = histogram->cumulativeCounts();
+      for (size_t i = 0; i < buckets.size(); ++i) {
+        out += fmt::format("{}_bucket{} {}\n", name, withLabel(labels, fmt::format("le=\"{}\"", buckets[i])), counts[i]);
+      }
+      out += fmt::format("{}_bucket{} {}\n", name, withLabel(labels, "le=\"+Inf\""), counts.back());
+      out += fmt::format("{}_sum{} {}\n", name, withLabels(labels), histogram->sum());
+      out += fmt::format("{}_count{} {}\n", name, withLabels(labels), histogram->count());
+    }
+  }
+  return out;
+}
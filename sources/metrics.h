@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// process wide metrics registry, exported in prometheus text format
+// metrics are registered once (slow, locked), updates are lock free relaxed atomics
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+class Counter {
+ public:
+  void inc(uint64_t value = 1) { m_value.fetch_add(value, std::memory_order_relaxed); }
+  uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> m_value{0};
+};
+
+class Gauge {
+ public:
+  void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+  void add(double value) { m_value.fetch_add(value, std::memory_order_relaxed); }
+  double value() const { return m_value.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<double> m_value{0.0};
+};
+
+class Histogram {
+ public:
+  explicit Histogram(const std::vector<double>& buckets);
+
+  void observe(double value);
+  std::vector<double> buckets() const;
+  std::vector<uint64_t> cumulativeCounts() const;  // last element is +Inf bucket
+  uint64_t count() const;
+  double sum() const;
+
+ private:
+  const std::vector<double> m_buckets;
+  std::unique_ptr<std::atomic<uint64_t>[]> m_counts;
+  std::atomic<uint64_t> m_count;
+  std::atomic<double> m_sum;
+};
+
+// measures scope duration in seconds
+class HistogramTimer {
+ public:
+  explicit HistogramTimer(Histogram& histogram) : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+  ~HistogramTimer() { m_histogram.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count()); }
+
+ private:
+  Histogram& m_histogram;
+  const std::chrono::steady_clock::time_point m_start;
+};
+
+class Metrics {
+ private:
+  Metrics() = delete;
+  ~Metrics() = delete;
+
+ public:
+  // returned references stay valid for process lifetime, same name and labels return same metric
+  static Counter& counter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+  static Gauge& gauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+  static Histogram& histogram(const std::string& name, const std::string& help, const MetricLabels& labels = {}, const std::vector<double>& buckets = defaultBuckets());
+
+  static std::vector<double> defaultBuckets();
+  static std::string serialize();
+};
@@ -0,0 +1,119 @@
+#include "metrics_exporter.h"
+
+#include <arpa/inet.h>
+#include <logger.h>
+#include <metrics.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utils/thread_utils.h>
+#include <utils/utils.h>
+
+#include <array>
+#include <cstring>
+
+constexpr auto LABEL = "metrics";
+constexpr auto LOOP_TIMEOUT = std::chrono::milliseconds(100);
+constexpr auto CLIENT_TIMEOUT = std::chrono::seconds(1);  // drop http client if request is not received in n
+constexpr auto MAX_REQUEST_SIZE = 4096;                   // only request line is parsed, rest is ignored
+
+MetricsExporter::MetricsExporter(const Config& config, RemoteController& remoteController)
+    : m_config(config), m_remoteController(remoteController), m_socket(-1), m_lastPublishTime(getTime()), m_isRunning(true) {
+  if (0 < m_config.metricsPort()) {
+    openSocket();
+  }
+  if (0 <= m_socket || 0 < m_config.metricsInterval().count()) {
+    m_thread = std::thread([this]() { worker(); });
+  }
+}
+
+MetricsExporter::~MetricsExporter() {
+  m_isRunning = false;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+  if (0 <= m_socket) {
+    close(m_socket);
+  }
+}
+
+void MetricsExporter::openSocket() {
+  m_socket = socket(AF_INET, SOCK_STREAM, 0);
+  if (m_socket < 0) {
+    Logger::warn(LABEL, "create socket failed: {}", std::strerror(errno));
+    return;
+  }
+  const int reuse = 1;
+  setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(m_config.metricsPort());
+  if (inet_pton(AF_INET, m_config.metricsAddress().c_str(), &address.sin_addr) != 1) {
+    Logger::warn(LABEL, "invalid bind address: {}", m_config.metricsAddress());
+    close(m_socket);
+    m_socket = -1;
+    return;
+  }
+  if (bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(m_socket, 4) != 0) {
+    Logger::warn(LABEL, "listen on {}:{} failed: {}", m_config.metricsAddress(), m_config.metricsPort(), std::strerror(errno));
+    close(m_socket);
+    m_socket = -1;
+    return;
+  }
+  Logger::info(LABEL, "http endpoint: {}", colored(GREEN, "http://{}:{}/metrics", m_config.metricsAddress(), m_config.metricsPort()));
+}
+
+void MetricsExporter::handleClient(int client) {
+  timeval timeout{CLIENT_TIMEOUT.count(), 0};
+  setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  std::array<char, MAX_REQUEST_SIZE> buffer;
+  const auto size = recv(client, buffer.data(), buffer.size(), 0);
+  const auto request = std::string(buffer.data(), std::max<ssize_t>(0, size));
+
+  std::string response;
+  if (request.starts_with("GET /metrics ") || request.starts_with("GET / ")) {
+    const auto body = Metrics::serialize();
+    response = fmt::format("HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}", body.size(), body);
+  } else {
+    response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  }
+  for (size_t offset = 0; offset < response.size();) {
+    const auto written = send(client, response.data() + offset, response.size() - offset, MSG_NOSIGNAL);
+    if (written <= 0) {
+      break;
+    }
+    offset += written;
+  }
+}
+
+void MetricsExporter::publish() {
+  const auto now = getTime();
+  if (0 < m_config.metricsInterval().count() && m_lastPublishTime + m_config.metricsInterval() <= now) {
+    m_remoteController.sendMetrics(Metrics::serialize());
+    m_lastPublishTime = now;
+  }
+}
+
+void MetricsExporter::worker() {
+  setThreadName("metrics");
+  Logger::info(LABEL, "started");
+  while (m_isRunning) {
+    if (0 <= m_socket) {
+      pollfd fd{m_socket, POLLIN, 0};
+      if (0 < poll(&fd, 1, LOOP_TIMEOUT.count()) && (fd.revents & POLLIN)) {
+        const auto client = accept(m_socket, nullptr, nullptr);
+        if (0 <= client) {
+          handleClient(client);
+          close(client);
+        }
+      }
+    } else {
+      std::this_thread::sleep_for(LOOP_TIMEOUT);
+    }
+    publish();
+  }
+  Logger::info(LABEL, "stopped");
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <config.h>
+#include <network/remote_controller.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// serves metrics registry in prometheus text format over http and periodically publishes it on mqtt
+class MetricsExporter {
+ public:
+  MetricsExporter(const Config& config, RemoteController& remoteController);
+  MetricsExporter(const MetricsExporter&) = delete;
+  MetricsExporter& operator=(const MetricsExporter&) = delete;
+  ~MetricsExporter();
+
+ private:
+  void openSocket();
+  void handleClient(int client);
+  void publish();
+  void worker();
+
+  const Config& m_config;
+  RemoteController& m_remoteController;
+  int m_socket;
+  std::chrono::milliseconds m_lastPublishTime;
+  std::atomic<bool> m_isRunning;
+  std::thread m_thread;
+};
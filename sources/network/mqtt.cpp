@@ -1,32 +1,61 @@
 #include "mqtt.h"
 
 #include <logger.h>
+#include <tracer.h>
+#include <utils/thread_utils.h>
 #include <utils/utils.h>
 
 constexpr auto LABEL = "mqtt";
 constexpr auto QOS_SUB = 2;
-constexpr auto QUEUE_MAX_SIZE = 1000;
+constexpr auto CONTROL_QUEUE_MAX_BYTES = 1 * 1024 * 1024;        // control messages, highest priority
+constexpr auto TRANSMISSION_QUEUE_MAX_BYTES = 64 * 1024 * 1024;  // recordings, published before spectrograms
+constexpr auto SPECTROGRAM_QUEUE_MAX_BYTES = 4 * 1024 * 1024;    // spectrograms, lowest priority
+constexpr auto MAX_INFLIGHT_MESSAGES = 64;                       // not yet acknowledged messages limit
+constexpr auto MAX_INFLIGHT_BYTES = 8 * 1024 * 1024;             // not yet acknowledged bytes limit
+constexpr auto STATS_INTERVAL = std::chrono::seconds(60);        // print queues stats every n
+constexpr auto DROP_LOG_INTERVAL = std::chrono::seconds(10);     // print dropped messages warning at most every n
+constexpr auto SPOOL_SEGMENT_SIZE = 16 * 1024 * 1024;            // disk spool single segment file size
+constexpr auto SPOOL_REPLAY_RATE = 512 * 1024;                   // replay spooled messages at most n bytes per second
 constexpr auto LOOP_TIMEOUT = std::chrono::milliseconds(10);
 constexpr auto RECONNECT_INTERVAL = std::chrono::seconds(5);
 constexpr auto CONNECT_TIMEOUT = std::chrono::seconds(5);
 constexpr auto KEEP_ALIVE = std::chrono::seconds(60);
 
 Mqtt::Mqtt(const Config& config)
-    : m_config(config), m_client(config.mqttUrl(), fmt::format("sdr-scanner-{}", config.getId())), m_isRunning(true), m_thread([this, config]() {
+    : m_config(config),
+      m_client(config.mqttUrl(), fmt::format("sdr-scanner-{}", config.getId())),
+      m_isRunning(true),
+      m_queues({Queue{"control", CONTROL_QUEUE_MAX_BYTES}, Queue{"transmission", TRANSMISSION_QUEUE_MAX_BYTES}, Queue{"spectrogram", SPECTROGRAM_QUEUE_MAX_BYTES}}),
+      m_inflightBytes(0),
+      m_inflightMetric(Metrics::gauge("mqtt_inflight_messages", "published messages waiting for acknowledge")),
+      m_spoolMetric(Metrics::gauge("mqtt_spool_bytes", "bytes waiting in disk spool")),
+      m_lastStatsTime(getTime()),
+      m_lastDropLogTime(0),
+      m_spool(0 < config.mqttSpoolSize() ? std::make_unique<Spool>(config.workDir() + "/mqtt_spool", static_cast<uint64_t>(config.mqttSpoolSize()) * 1024 * 1024, SPOOL_SEGMENT_SIZE) : nullptr),
+      m_replayBudget(0),
+      m_lastReplayTime(getTime()),
+      m_nextCallbackId(0),
+      m_thread([this]() {
+        setThreadName("mqtt");
         Logger::info(LABEL, "started");
+        m_client.start_consuming();
         connect();
         while (m_isRunning) {
           if (m_client.is_connected()) {
-            std::shared_ptr<const mqtt::message> message;
-            while (m_client.try_consume_message_for(&message, LOOP_TIMEOUT) && message) {
-              onMessage(message->get_topic(), message->get_payload());
-            }
-            while (m_isRunning && !m_messages.empty()) {
-              const auto& [topic, data, qos] = m_messages.front();
-              m_client.publish(topic, data.data(), data.size(), qos, false);
-              std::unique_lock lock(m_mutex);
-              m_messages.pop();
+            mqtt::const_message_ptr message;
+            while (m_client.try_consume_message(&message) && message) {
+              onMessage(message->get_topic(), message->get_payload_str());
             }
+            releaseDelivered();
+            replaySpool();
+            publishPending();
+            logStats();
+
+            std::unique_lock lock(m_mutex);
+            m_cv.wait_for(lock, LOOP_TIMEOUT, [this]() {
+              const auto hasMessages = std::any_of(m_queues.begin(), m_queues.end(), [](const Queue& queue) { return !queue.messages.empty(); });
+              return !m_isRunning || (hasMessages && static_cast<int>(m_inflight.size()) < MAX_INFLIGHT_MESSAGES && static_cast<int>(m_inflightBytes) < MAX_INFLIGHT_BYTES);
+            });
           } else {
             onDisconnected();
             while (m_isRunning && !m_client.is_connected()) {
@@ -43,44 +72,45 @@ Mqtt::Mqtt(const Config& config)
 
 Mqtt::~Mqtt() {
   m_isRunning = false;
+  m_cv.notify_all();
   m_thread.join();
   if (m_client.is_connected()) {
-    m_client.disconnect();
+    try {
+      m_client.disconnect()->wait();
+    } catch (const std::runtime_error& exception) {
+      Logger::exception(LABEL, exception, SPDLOG_LOC, "disconnect failed");
+    }
   }
+  m_client.stop_consuming();
 }
 
-void Mqtt::publish(const std::string& topic, const std::string& data, int qos) {
-  std::unique_lock lock(m_mutex);
-  if (m_messages.size() < QUEUE_MAX_SIZE) {
-    m_messages.emplace(topic, std::vector<uint8_t>{data.begin(), data.end()}, qos);
-    Logger::trace(LABEL, "queue size: {}", m_messages.size());
-  }
-}
+void Mqtt::publish(const std::string& topic, const std::string& data, int qos, Lane lane) { push({topic, data, qos}, lane); }
 
-void Mqtt::publish(const std::string& topic, const std::vector<uint8_t>& data, int qos) {
-  std::unique_lock lock(m_mutex);
-  if (m_messages.size() < QUEUE_MAX_SIZE) {
-    m_messages.emplace(topic, data, qos);
-    Logger::trace(LABEL, "queue size: {}", m_messages.size());
-  }
-}
+void Mqtt::publish(const std::string& topic, mqtt::binary&& data, int qos, Lane lane) { push({topic, std::move(data), qos}, lane); }
 
-void Mqtt::publish(const std::string& topic, const std::vector<uint8_t>&& data, int qos) {
+Mqtt::CallbackId Mqtt::setRawMessageCallback(const std::string& topic, const RawCallback& callback) {
   std::unique_lock lock(m_mutex);
-  if (m_messages.size() < QUEUE_MAX_SIZE) {
-    m_messages.emplace(topic, std::move(data), qos);
-    Logger::trace(LABEL, "queue size: {}", m_messages.size());
-  }
+  subscribe(topic);
+  const auto id = m_nextCallbackId++;
+  m_rawCallbacks.emplace(id, std::make_pair(topic, callback));
+  return id;
 }
 
-void Mqtt::setRawMessageCallback(const std::string& topic, const RawCallback& callback) {
+Mqtt::CallbackId Mqtt::setJsonMessageCallback(const std::string& topic, const JsonCallback& callback) {
+  std::unique_lock lock(m_mutex);
   subscribe(topic);
-  m_rawCallbacks.emplace_back(topic, callback);
+  const auto id = m_nextCallbackId++;
+  m_jsonCallbacks.emplace(id, std::make_pair(topic, callback));
+  return id;
 }
 
-void Mqtt::setJsonMessageCallback(const std::string& topic, const JsonCallback& callback) {
-  subscribe(topic);
-  m_jsonCallbacks.emplace_back(topic, callback);
+void Mqtt::removeCallback(CallbackId id) {
+  std::unique_lock lock(m_mutex);
+  m_rawCallbacks.erase(id);
+  m_jsonCallbacks.erase(id);
+  lock.unlock();
+  // snapshot taken before erase may still contain callback
+  std::unique_lock dispatchLock(m_dispatchMutex);
 }
 
 void Mqtt::connect() {
@@ -96,11 +126,13 @@ void Mqtt::connect() {
                            .connect_timeout(CONNECT_TIMEOUT)
                            .automatic_reconnect(false)
                            .clean_session(true)
+                           .max_inflight(MAX_INFLIGHT_MESSAGES)
                            .finalize();
 
   try {
-    const auto response = m_client.connect(options);
-    if (response.is_session_present()) {
+    const auto token = m_client.connect(options);
+    token->wait();
+    if (token->get_connect_response().is_session_present()) {
       Logger::info(LABEL, "session already present");
     } else {
       Logger::info(LABEL, "new session created");
@@ -130,10 +162,21 @@ void Mqtt::onConnected() {
   m_waitingTopics.clear();
 }
 
-void Mqtt::onDisconnected() { Logger::info(LABEL, "disconnected"); }
+void Mqtt::onDisconnected() {
+  Logger::info(LABEL, "disconnected");
+  std::unique_lock lock(m_mutex);
+  // clean session drops unacknowledged messages, publish them again after reconnect
+  auto messages = takeInflight(false);
+  lock.unlock();
+  if (!messages.empty()) {
+    Logger::warn(LABEL, "requeue not acknowledged messages: {}", colored(RED, "{}", messages.size()));
+  }
+  for (auto& [message, lane] : messages) {
+    push(std::move(message), lane);
+  }
+}
 
 void Mqtt::subscribe(const std::string& topic) {
-  std::unique_lock lock(m_mutex);
   if (m_client.is_connected()) {
     if (m_topics.count(topic) == 0) {
       Logger::info(LABEL, "subscribe: {}", colored(GREEN, "{}", topic));
@@ -147,22 +190,195 @@ void Mqtt::subscribe(const std::string& topic) {
 
 void Mqtt::onMessage(const std::string& topic, const std::string& data) {
   Logger::debug(LABEL, "topic: {}, data: {}", topic, data);
-  for (auto& [callbackTopic, callback] : m_rawCallbacks) {
-    if (topic == callbackTopic) {
-      callback(data);
+  // callbacks are called without lock, they may publish responses
+  std::vector<RawCallback> rawCallbacks;
+  std::vector<JsonCallback> jsonCallbacks;
+  std::unique_lock dispatchLock(m_dispatchMutex);
+  std::unique_lock lock(m_mutex);
+  for (const auto& [id, callback] : m_rawCallbacks) {
+    if (topic == callback.first) {
+      rawCallbacks.push_back(callback.second);
+    }
+  }
+  for (const auto& [id, callback] : m_jsonCallbacks) {
+    if (topic == callback.first) {
+      jsonCallbacks.push_back(callback.second);
     }
   }
-  const auto count = std::count_if(m_jsonCallbacks.begin(), m_jsonCallbacks.end(), [&topic](const auto& data) { return data.first == topic; });
-  if (0 < count) {
+  lock.unlock();
+
+  for (const auto& callback : rawCallbacks) {
+    callback(data);
+  }
+  if (!jsonCallbacks.empty()) {
     try {
       const auto json = nlohmann::json::parse(data);
-      for (auto& [callbackTopic, callback] : m_jsonCallbacks) {
-        if (topic == callbackTopic) {
-          callback(json);
-        }
+      for (const auto& callback : jsonCallbacks) {
+        callback(json);
       }
     } catch (const std::exception& exception) {
       Logger::exception(LABEL, exception, SPDLOG_LOC, "parse message to json failed");
     }
   }
 }
+
+void Mqtt::push(Message&& message, Lane lane) {
+  std::unique_lock lock(m_mutex);
+  auto& queue = m_queues[static_cast<int>(lane)];
+  const auto size = message.size();
+  if (m_spool && lane == Lane::Transmission && (!m_client.is_connected() || queue.maxBytes < queue.bytes + size)) {
+    // segment creation and copy into mapped file must not block other publishers
+    lock.unlock();
+    try {
+      std::unique_lock spoolLock(m_spoolMutex);
+      if (m_spool->push(message.topic, message.data, message.qos)) {
+        m_spoolMetric.set(m_spool->size());
+        return;
+      }
+    } catch (const std::runtime_error& exception) {
+      Logger::exception(LABEL, exception, SPDLOG_LOC, "spool message failed");
+    }
+    lock.lock();
+  }
+  if (queue.maxBytes < queue.bytes + size) {
+    queue.dropped++;
+    queue.droppedTotal.inc();
+    const auto now = getTime();
+    if (m_lastDropLogTime + DROP_LOG_INTERVAL <= now) {
+      Logger::warn(LABEL, "queue full, lane: {}, size: {} bytes, dropped: {}", queue.name, queue.bytes, colored(RED, "{}", queue.dropped));
+      m_lastDropLogTime = now;
+    }
+    return;
+  }
+  queue.bytes += size;
+  queue.messages.push_back(std::move(message));
+  queue.updateMetrics();
+  m_cv.notify_one();
+}
+
+bool Mqtt::pop(Message& message, Lane& lane) {
+  std::unique_lock lock(m_mutex);
+  if (MAX_INFLIGHT_MESSAGES <= static_cast<int>(m_inflight.size()) || MAX_INFLIGHT_BYTES <= static_cast<int>(m_inflightBytes)) {
+    return false;
+  }
+  for (size_t i = 0; i < m_queues.size(); ++i) {
+    auto& queue = m_queues[i];
+    if (!queue.messages.empty()) {
+      message = std::move(queue.messages.front());
+      queue.messages.pop_front();
+      queue.bytes -= message.size();
+      queue.published++;
+      queue.publishedTotal.inc();
+      queue.updateMetrics();
+      lane = static_cast<Lane>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+void Mqtt::publishPending() {
+  Message message;
+  Lane lane;
+  while (m_isRunning && m_client.is_connected() && pop(message, lane)) {
+    const auto size = message.size();
+    try {
+      Tracer::Scope scope("mqtt publish", "bytes", static_cast<int64_t>(size));
+      // payload is moved into paho message, no copy on our side
+      auto token = m_client.publish(mqtt::make_message(message.topic, std::move(message.data), message.qos, false));
+      std::unique_lock lock(m_mutex);
+      m_inflight.push_back({std::move(token), size, lane});
+      m_inflightBytes += size;
+      m_inflightMetric.set(m_inflight.size());
+    } catch (const std::runtime_error& exception) {
+      Logger::exception(LABEL, exception, SPDLOG_LOC, "publish failed, topic: {}", message.topic);
+    }
+  }
+}
+
+void Mqtt::releaseDelivered() {
+  std::unique_lock lock(m_mutex);
+  // broker may acknowledge qos 1 and qos 2 messages out of order
+  auto messages = takeInflight(true);
+  lock.unlock();
+  if (!messages.empty()) {
+    Logger::warn(LABEL, "requeue failed messages: {}", colored(RED, "{}", messages.size()));
+  }
+  for (auto& [message, lane] : messages) {
+    push(std::move(message), lane);
+  }
+}
+
+std::vector<std::pair<Mqtt::Message, Mqtt::Lane>> Mqtt::takeInflight(bool isFailedOnly) {
+  std::vector<std::pair<Message, Lane>> messages;
+  const auto it = std::remove_if(m_inflight.begin(), m_inflight.end(), [this, isFailedOnly, &messages](const Inflight& inflight) {
+    const auto isComplete = inflight.token->is_complete();
+    if (isFailedOnly && !isComplete) {
+      return false;
+    }
+    if (!isComplete || inflight.token->get_return_code() != MQTTASYNC_SUCCESS) {
+      const auto message = inflight.token->get_message();
+      if (message && 0 < message->get_qos()) {
+        messages.emplace_back(Message{message->get_topic(), message->get_payload(), message->get_qos()}, inflight.lane);
+      }
+    }
+    m_inflightBytes -= inflight.size;
+    return true;
+  });
+  m_inflight.erase(it, m_inflight.end());
+  m_inflightMetric.set(m_inflight.size());
+  return messages;
+}
+
+void Mqtt::replaySpool() {
+  if (!m_spool) {
+    return;
+  }
+  const auto now = getTime();
+  const auto elapsed = (now - m_lastReplayTime).count();
+  m_replayBudget = std::min<uint64_t>(SPOOL_REPLAY_RATE, m_replayBudget + SPOOL_REPLAY_RATE * elapsed / 1000);
+  m_lastReplayTime = now;
+
+  auto& queue = m_queues[static_cast<int>(Lane::Transmission)];
+  const auto isQueueFree = [this, &queue]() {
+    std::unique_lock lock(m_mutex);
+    return queue.bytes < queue.maxBytes / 2;
+  };
+  Message message;
+  while (0 < m_replayBudget && isQueueFree()) {
+    std::unique_lock spoolLock(m_spoolMutex);
+    if (!m_spool->pop(message.topic, message.data, message.qos)) {
+      return;
+    }
+    m_spoolMetric.set(m_spool->size());
+    const auto isCompleted = m_spool->empty();
+    spoolLock.unlock();
+
+    m_replayBudget -= std::min<uint64_t>(m_replayBudget, message.size());
+    std::unique_lock lock(m_mutex);
+    queue.bytes += message.size();
+    queue.messages.push_back(std::move(message));
+    queue.updateMetrics();
+    lock.unlock();
+    if (isCompleted) {
+      Logger::info(LABEL, "spool replay completed");
+    }
+  }
+}
+
+void Mqtt::logStats() {
+  const auto now = getTime();
+  if (m_lastStatsTime + STATS_INTERVAL <= now) {
+    std::unique_lock lock(m_mutex);
+    for (const auto& queue : m_queues) {
+      Logger::debug(LABEL, "lane: {}, queued: {}, size: {} bytes, published: {}, dropped: {}", queue.name, queue.messages.size(), queue.bytes, queue.published, queue.dropped);
+    }
+    Logger::debug(LABEL, "inflight: {}, size: {} bytes", m_inflight.size(), m_inflightBytes);
+    lock.unlock();
+    if (m_spool) {
+      std::unique_lock spoolLock(m_spoolMutex);
+      Logger::debug(LABEL, "spool: {} bytes, evicted segments: {}", m_spool->size(), m_spool->evictedSegments());
+    }
+    m_lastStatsTime = now;
+  }
+}
@@ -1,12 +1,18 @@
 #pragma once
 
 #include <config.h>
-#include <mqtt/client.h>
+#include <metrics.h>
+#include <mqtt/async_client.h>
+#include <network/spool.h>
 
+#include <array>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <set>
 #include <string>
 #include <thread>
@@ -16,31 +22,95 @@ class Mqtt {
  public:
   using RawCallback = std::function<void(const std::string&)>;
   using JsonCallback = std::function<void(const nlohmann::json&)>;
+  using CallbackId = uint64_t;
+
+  // lanes are published in order, lower lane first
+  enum class Lane { Control = 0, Transmission = 1, Spectrogram = 2 };
 
   Mqtt(const Config& config);
   ~Mqtt();
 
-  void publish(const std::string& topic, const std::string& data, int qos = 0);
-  void publish(const std::string& topic, const std::vector<uint8_t>& data, int qos = 0);
-  void publish(const std::string& topic, const std::vector<uint8_t>&& data, int qos = 0);
-  void setRawMessageCallback(const std::string& topic, const RawCallback& callback);
-  void setJsonMessageCallback(const std::string& topic, const JsonCallback& callback);
+  void publish(const std::string& topic, const std::string& data, int qos = 0, Lane lane = Lane::Control);
+  void publish(const std::string& topic, mqtt::binary&& data, int qos = 0, Lane lane = Lane::Control);
+  // thread safe, devices register callbacks from parallel constructors
+  CallbackId setRawMessageCallback(const std::string& topic, const RawCallback& callback);
+  CallbackId setJsonMessageCallback(const std::string& topic, const JsonCallback& callback);
+  // callback is not running and will not be called after return, must not be called from callback
+  void removeCallback(CallbackId id);
 
  private:
+  struct Message {
+    std::string topic;
+    mqtt::binary data;
+    int qos;
+
+    size_t size() const { return topic.size() + data.size(); }
+  };
+
+  struct Queue {
+    const char* name;
+    const size_t maxBytes;
+    std::deque<Message> messages{};
+    size_t bytes = 0;
+    uint64_t published = 0;
+    uint64_t dropped = 0;
+    Gauge& queuedMessages = Metrics::gauge("mqtt_queue_messages", "messages waiting in lane", {{"lane", name}});
+    Gauge& queuedBytes = Metrics::gauge("mqtt_queue_bytes", "bytes waiting in lane", {{"lane", name}});
+    Counter& publishedTotal = Metrics::counter("mqtt_published_total", "messages published from lane", {{"lane", name}});
+    Counter& droppedTotal = Metrics::counter("mqtt_dropped_total", "messages dropped from full lane", {{"lane", name}});
+
+    void updateMetrics() {
+      queuedMessages.set(messages.size());
+      queuedBytes.set(bytes);
+    }
+  };
+
+  // payload stays in paho message of token, it is copied back only when delivery failed
+  struct Inflight {
+    mqtt::delivery_token_ptr token;
+    size_t size;
+    Lane lane;
+  };
+
   void connect();
   void onConnected();
   void onDisconnected();
   void onMessage(const std::string& topic, const std::string& data);
+  // requires m_mutex
   void subscribe(const std::string& topic);
+  void push(Message&& message, Lane lane);
+  bool pop(Message& message, Lane& lane);
+  void publishPending();
+  void releaseDelivered();
+  // requires m_mutex, returns messages to publish again, qos 0 messages are dropped
+  std::vector<std::pair<Message, Lane>> takeInflight(bool isFailedOnly);
+  void replaySpool();
+  void logStats();
 
   const Config& m_config;
-  mqtt::client m_client;
+  mqtt::async_client m_client;
   std::atomic_bool m_isRunning;
-  std::thread m_thread;
   std::mutex m_mutex;
-  std::queue<std::tuple<std::string, std::vector<uint8_t>, int>> m_messages;
+  std::condition_variable m_cv;
+  std::array<Queue, 3> m_queues;
+  std::deque<Inflight> m_inflight;
+  size_t m_inflightBytes;
+  Gauge& m_inflightMetric;
+  Gauge& m_spoolMetric;
+  std::chrono::milliseconds m_lastStatsTime;
+  std::chrono::milliseconds m_lastDropLogTime;
+  // spool is not thread safe, own lock keeps disk io out of m_mutex
+  std::mutex m_spoolMutex;
+  std::unique_ptr<Spool> m_spool;
+  uint64_t m_replayBudget;
+  std::chrono::milliseconds m_lastReplayTime;
   std::set<std::string> m_topics;
   std::set<std::string> m_waitingTopics;
-  std::vector<std::pair<std::string, RawCallback>> m_rawCallbacks;
-  std::vector<std::pair<std::string, JsonCallback>> m_jsonCallbacks;
+  // ordered by id, callbacks are called in registration order
+  CallbackId m_nextCallbackId;
+  std::map<CallbackId, std::pair<std::string, RawCallback>> m_rawCallbacks;
+  std::map<CallbackId, std::pair<std::string, JsonCallback>> m_jsonCallbacks;
+  // held while callbacks run, removeCallback waits for running dispatch
+  std::mutex m_dispatchMutex;
+  std::thread m_thread;
 };
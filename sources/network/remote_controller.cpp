@@ -9,12 +9,16 @@ constexpr auto STATUS = "status";
 constexpr auto CONFIG = "config";
 constexpr auto TMP_CONFIG = "tmp_config";
 constexpr auto RESET_TMP_CONFIG = "reset_tmp_config";
+constexpr auto DETECTION = "detection";
 constexpr auto SCHEDULER = "scheduler";
+constexpr auto TRACE_DUMP = "trace_dump";
 constexpr auto SUCCESS = "success";
 constexpr auto FAILED = "failed";
 constexpr auto LABEL = "remote";
 constexpr auto SPECTROGRAM = "spectrogram";
+constexpr auto SPECTROGRAM_SUBSCRIBE = "spectrogram_subscribe";
 constexpr auto TRANSMISSION = "transmission";
+constexpr auto METRICS = "metrics";
 
 using namespace std::placeholders;
 
@@ -32,14 +36,28 @@ void RemoteController::resetTmpConfigResponse(const bool& success) { m_mqtt.publ
 void RemoteController::setTmpConfigQuery(const Mqtt::JsonCallback& callback) { m_mqtt.setJsonMessageCallback(fmt::format("sdr/{}/{}", TMP_CONFIG, m_config.getId()), callback); }
 void RemoteController::setTmpConfigResponse(const bool& success) { m_mqtt.publish(fmt::format("sdr/{}/{}/{}", TMP_CONFIG, m_config.getId(), success ? SUCCESS : FAILED), "", 2); }
 
+void RemoteController::setDetectionQuery(const Mqtt::JsonCallback& callback) { m_mqtt.setJsonMessageCallback(fmt::format("sdr/{}/{}", DETECTION, m_config.getId()), callback); }
+void RemoteController::setDetectionResponse(const bool& success) { m_mqtt.publish(fmt::format("sdr/{}/{}/{}", DETECTION, m_config.getId(), success ? SUCCESS : FAILED), "", 2); }
+
+void RemoteController::traceDumpQuery(const Mqtt::RawCallback& callback) { m_mqtt.setRawMessageCallback(fmt::format("sdr/{}/{}", TRACE_DUMP, m_config.getId()), callback); }
+void RemoteController::traceDumpResponse(const bool& success) { m_mqtt.publish(fmt::format("sdr/{}/{}/{}", TRACE_DUMP, m_config.getId(), success ? SUCCESS : FAILED), "", 2); }
+
 void RemoteController::schedulerQuery(const Device& device, const std::string& query) { m_mqtt.publish(fmt::format("sdr/{}/{}/{}/get", SCHEDULER, m_config.getId(), device.getName()), query, 2); }
-void RemoteController::schedulerCallback(const Device& device, const Mqtt::JsonCallback& callback) {
-  m_mqtt.setJsonMessageCallback(fmt::format("sdr/{}/{}/{}/set", SCHEDULER, m_config.getId(), device.getName()), callback);
+Mqtt::CallbackId RemoteController::schedulerCallback(const Device& device, const Mqtt::JsonCallback& callback) {
+  return m_mqtt.setJsonMessageCallback(fmt::format("sdr/{}/{}/{}/set", SCHEDULER, m_config.getId(), device.getName()), callback);
+}
+
+Mqtt::CallbackId RemoteController::spectrogramSubscribeCallback(const Device& device, const Mqtt::RawCallback& callback) {
+  return m_mqtt.setRawMessageCallback(fmt::format("sdr/{}/{}/{}", SPECTROGRAM_SUBSCRIBE, m_config.getId(), device.getAliasName()), callback);
 }
 
+void RemoteController::removeCallback(Mqtt::CallbackId id) { m_mqtt.removeCallback(id); }
+
 void RemoteController::sendSpectrogram(const Device& device, const nlohmann::json& json) {
-  m_mqtt.publish(fmt::format("sdr/{}/{}/{}", SPECTROGRAM, m_config.getId(), device.getAliasName()), json.dump(), 2);
+  m_mqtt.publish(fmt::format("sdr/{}/{}/{}", SPECTROGRAM, m_config.getId(), device.getAliasName()), json.dump(), 2, Mqtt::Lane::Spectrogram);
 }
-void RemoteController::sendTransmission(const Device& device, const nlohmann::json& json) {
-  m_mqtt.publish(fmt::format("sdr/{}/{}/{}", TRANSMISSION, m_config.getId(), device.getAliasName()), json.dump(), 2);
+void RemoteController::sendTransmission(const Device& device, std::string&& data) {
+  m_mqtt.publish(fmt::format("sdr/{}/{}/{}", TRANSMISSION, m_config.getId(), device.getAliasName()), std::move(data), 2, Mqtt::Lane::Transmission);
 }
+
+void RemoteController::sendMetrics(const std::string& data) { m_mqtt.publish(fmt::format("sdr/{}/{}", METRICS, m_config.getId()), data, 0); }
@@ -23,11 +23,23 @@ class RemoteController {
   void setTmpConfigQuery(const Mqtt::JsonCallback& callback);
   void setTmpConfigResponse(const bool& success);
 
+  // detection parameters only, applied without restarting devices
+  void setDetectionQuery(const Mqtt::JsonCallback& callback);
+  void setDetectionResponse(const bool& success);
+
+  void traceDumpQuery(const Mqtt::RawCallback& callback);
+  void traceDumpResponse(const bool& success);
+
   void schedulerQuery(const Device& device, const std::string& query);
-  void schedulerCallback(const Device& device, const Mqtt::JsonCallback& callback);
+  Mqtt::CallbackId schedulerCallback(const Device& device, const Mqtt::JsonCallback& callback);
 
+  Mqtt::CallbackId spectrogramSubscribeCallback(const Device& device, const Mqtt::RawCallback& callback);
+  // device callbacks are removed when device is closed, otherwise they outlive their owner
+  void removeCallback(Mqtt::CallbackId id);
   void sendSpectrogram(const Device& device, const nlohmann::json& json);
-  void sendTransmission(const Device& device, const nlohmann::json& json);
+  void sendTransmission(const Device& device, std::string&& data);
+
+  void sendMetrics(const std::string& data);
 
  private:
   void listCallback(const std::string& data);
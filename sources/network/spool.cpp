@@ -0,0 +1,192 @@
+#include "spool.h"
+
+#include <fcntl.h>
+#include <logger.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <regex>
+#include <stdexcept>
+#include <vector>
+
+constexpr auto LABEL = "spool";
+constexpr uint64_t HEADER_SIZE = 2 * sizeof(uint64_t);         // read offset, write offset
+constexpr uint64_t RECORD_HEADER_SIZE = 3 * sizeof(uint32_t);  // topic size, data size, qos
+
+namespace {
+uint64_t readU64(const uint8_t* data) {
+  uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void writeU64(uint8_t* data, uint64_t value) { std::memcpy(data, &value, sizeof(value)); }
+
+uint32_t readU32(const uint8_t* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void writeU32(uint8_t* data, uint32_t value) { std::memcpy(data, &value, sizeof(value)); }
+
+uint64_t getReadOffset(const uint8_t* data) { return readU64(data); }
+uint64_t getWriteOffset(const uint8_t* data) { return readU64(data + sizeof(uint64_t)); }
+void setReadOffset(uint8_t* data, uint64_t offset) { writeU64(data, offset); }
+void setWriteOffset(uint8_t* data, uint64_t offset) { writeU64(data + sizeof(uint64_t), offset); }
+}  // namespace
+
+Spool::Spool(const std::string& dir, uint64_t maxSize, uint64_t segmentSize)
+    : m_dir(dir), m_segmentSize(std::min(segmentSize, maxSize / 2)), m_maxSegments(m_segmentSize ? maxSize / m_segmentSize : 0), m_evictedSegments(0) {
+  // at least two segments, one written and one read, must fit into size limit
+  if (m_segmentSize <= HEADER_SIZE + RECORD_HEADER_SIZE) {
+    throw std::runtime_error(fmt::format("spool size too small: {} bytes", maxSize));
+  }
+  if (m_segmentSize < segmentSize) {
+    Logger::warn(LABEL, "size limit below two segments, segment size reduced to: {} bytes", m_segmentSize);
+  }
+  std::filesystem::create_directories(m_dir);
+
+  std::vector<uint64_t> ids;
+  const std::regex regex(R"(^segment_(\d+)\.bin$)");
+  for (const auto& entry : std::filesystem::directory_iterator(m_dir)) {
+    std::smatch match;
+    const auto name = entry.path().filename().string();
+    if (std::regex_match(name, match, regex)) {
+      if (entry.file_size() == m_segmentSize) {
+        ids.push_back(std::stoull(match[1]));
+      } else {
+        Logger::warn(LABEL, "invalid segment size, removing: {}", name);
+        std::filesystem::remove(entry.path());
+      }
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+  for (const auto id : ids) {
+    auto segment = openSegment(id, false);
+    const auto readOffset = getReadOffset(segment.data);
+    const auto writeOffset = getWriteOffset(segment.data);
+    if (readOffset < HEADER_SIZE || writeOffset < readOffset || m_segmentSize < writeOffset) {
+      Logger::warn(LABEL, "invalid segment header, removing: {}", segment.path);
+      closeSegment(segment, true);
+    } else {
+      m_segments.push_back(segment);
+    }
+  }
+  while (m_maxSegments < m_segments.size()) {
+    closeSegment(m_segments.front(), true);
+    m_segments.pop_front();
+  }
+  Logger::info(LABEL, "dir: {}, segments: {}, pending: {} bytes", colored(GREEN, "{}", m_dir), colored(GREEN, "{}", m_segments.size()), colored(GREEN, "{}", size()));
+}
+
+Spool::~Spool() {
+  for (auto& segment : m_segments) {
+    closeSegment(segment, false);
+  }
+}
+
+bool Spool::push(const std::string& topic, const std::string& data, int qos) {
+  const auto recordSize = RECORD_HEADER_SIZE + topic.size() + data.size();
+  if (m_segmentSize < HEADER_SIZE + recordSize) {
+    return false;
+  }
+  if (m_segments.empty() || m_segmentSize < getWriteOffset(m_segments.back().data) + recordSize) {
+    const auto id = m_segments.empty() ? 0 : m_segments.back().id + 1;
+    m_segments.push_back(openSegment(id, true));
+    if (m_maxSegments < m_segments.size()) {
+      Logger::warn(LABEL, "size limit reached, evicting oldest segment: {}", m_segments.front().path);
+      closeSegment(m_segments.front(), true);
+      m_segments.pop_front();
+      m_evictedSegments++;
+    }
+  }
+
+  auto* segment = m_segments.back().data;
+  const auto offset = getWriteOffset(segment);
+  auto* record = segment + offset;
+  writeU32(record, topic.size());
+  writeU32(record + sizeof(uint32_t), data.size());
+  writeU32(record + 2 * sizeof(uint32_t), qos);
+  std::memcpy(record + RECORD_HEADER_SIZE, topic.data(), topic.size());
+  std::memcpy(record + RECORD_HEADER_SIZE + topic.size(), data.data(), data.size());
+  setWriteOffset(segment, offset + recordSize);
+  return true;
+}
+
+bool Spool::pop(std::string& topic, std::string& data, int& qos) {
+  while (!m_segments.empty()) {
+    auto* segment = m_segments.front().data;
+    const auto readOffset = getReadOffset(segment);
+    const auto writeOffset = getWriteOffset(segment);
+    if (readOffset < writeOffset) {
+      const auto* record = segment + readOffset;
+      // sizes are not trusted, segment may be damaged by crash
+      if (writeOffset < readOffset + RECORD_HEADER_SIZE || writeOffset < readOffset + RECORD_HEADER_SIZE + readU32(record) + readU32(record + sizeof(uint32_t))) {
+        Logger::warn(LABEL, "invalid record, removing segment: {}", m_segments.front().path);
+        closeSegment(m_segments.front(), true);
+        m_segments.pop_front();
+        continue;
+      }
+      const auto topicSize = readU32(record);
+      const auto dataSize = readU32(record + sizeof(uint32_t));
+      qos = readU32(record + 2 * sizeof(uint32_t));
+      topic.assign(reinterpret_cast<const char*>(record + RECORD_HEADER_SIZE), topicSize);
+      data.assign(reinterpret_cast<const char*>(record + RECORD_HEADER_SIZE + topicSize), dataSize);
+      setReadOffset(segment, readOffset + RECORD_HEADER_SIZE + topicSize + dataSize);
+      return true;
+    } else if (1 < m_segments.size()) {
+      closeSegment(m_segments.front(), true);
+      m_segments.pop_front();
+    } else {
+      setReadOffset(segment, HEADER_SIZE);
+      setWriteOffset(segment, HEADER_SIZE);
+      return false;
+    }
+  }
+  return false;
+}
+
+bool Spool::empty() const { return size() == 0; }
+
+uint64_t Spool::size() const {
+  uint64_t size = 0;
+  for (const auto& segment : m_segments) {
+    size += getWriteOffset(segment.data) - getReadOffset(segment.data);
+  }
+  return size;
+}
+
+uint64_t Spool::evictedSegments() const { return m_evictedSegments; }
+
+Spool::Segment Spool::openSegment(uint64_t id, bool create) const {
+  const auto path = fmt::format("{}/segment_{:016d}.bin", m_dir, id);
+  const auto fd = open(path.c_str(), O_RDWR | (create ? O_CREAT | O_TRUNC : 0), 0644);
+  if (fd < 0) {
+    throw std::runtime_error(fmt::format("open spool segment failed: {}", path));
+  }
+  if (create && ftruncate(fd, m_segmentSize) != 0) {
+    close(fd);
+    throw std::runtime_error(fmt::format("resize spool segment failed: {}", path));
+  }
+  auto* data = static_cast<uint8_t*>(mmap(nullptr, m_segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error(fmt::format("map spool segment failed: {}", path));
+  }
+  if (create) {
+    setReadOffset(data, HEADER_SIZE);
+    setWriteOffset(data, HEADER_SIZE);
+  }
+  return {id, path, data};
+}
+
+void Spool::closeSegment(Segment& segment, bool remove) const {
+  munmap(segment.data, m_segmentSize);
+  if (remove) {
+    std::filesystem::remove(segment.path);
+  }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+// append-only, memory-mapped message spool split into fixed size segment files
+// oldest segment is evicted when size limit is reached, not thread safe
+class Spool {
+  struct Segment {
+    uint64_t id;
+    std::string path;
+    uint8_t* data;
+  };
+
+ public:
+  Spool(const std::string& dir, uint64_t maxSize, uint64_t segmentSize);
+  Spool(const Spool&) = delete;
+  Spool& operator=(const Spool&) = delete;
+  ~Spool();
+
+  bool push(const std::string& topic, const std::string& data, int qos);
+  bool pop(std::string& topic, std::string& data, int& qos);
+
+  bool empty() const;
+  uint64_t size() const;
+  uint64_t evictedSegments() const;
+
+ private:
+  Segment openSegment(uint64_t id, bool create) const;
+  void closeSegment(Segment& segment, bool remove) const;
+
+  const std::string m_dir;
+  const uint64_t m_segmentSize;
+  const uint64_t m_maxSegments;
+  std::deque<Segment> m_segments;
+  uint64_t m_evictedSegments;
+};
@@ -2,51 +2,226 @@
 
 #include <utils/utils.h>
 
+#include <bit>
+#include <cmath>
 #include <cstring>
 
-Averager::Averager(int size, int groupSize) : m_size(size), m_groupSize(groupSize), m_sum(size, 0.0), m_average(size, 0.0), m_frames(0) {
-  for (int i = 0; i < m_groupSize; ++i) {
-    m_buffers.emplace_back(m_size, 0.0);
+constexpr auto INT16_STEP = 0.25f;  // dB per int16 unit
+constexpr auto INT8_STEP = 0.5f;    // dB per int8 unit, keeps -64 to 63.5 dB range
+
+namespace {
+
+// ieee 754 binary16 kept as raw bits, Half is not available on every target (arm32)
+struct Half {
+  uint16_t bits;
+};
+
+float halfToFloat(uint16_t half) {
+  const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+  const uint32_t exponent = (half >> 10) & 0x1f;
+  const uint32_t mantissa = half & 0x3ff;
+  if (exponent == 0x1f) {
+    return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+  }
+  if (exponent == 0) {
+    // zero and subnormals, exact in float
+    const auto value = std::ldexp(static_cast<float>(mantissa), -24);
+    return sign ? -value : value;
+  }
+  return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+// rounds to nearest even as hardware conversion does
+uint16_t floatToHalf(float value) {
+  const auto bits = std::bit_cast<uint32_t>(value);
+  const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+  const auto exponent = static_cast<int>((bits >> 23) & 0xff);
+  const auto mantissa = bits & 0x7fffff;
+  if (exponent == 0xff) {
+    return sign | 0x7c00 | (mantissa ? 0x200 : 0);
   }
+  const auto halfExponent = exponent - 112;
+  if (0x1f <= halfExponent) {
+    return sign | 0x7c00;
+  }
+  if (halfExponent <= 0) {
+    if (halfExponent < -10) {
+      return sign;
+    }
+    // subnormal, implicit leading one is shifted into mantissa
+    const auto full = mantissa | 0x800000;
+    const auto shift = 14 - halfExponent;
+    const auto half = full >> shift;
+    const auto rest = full & ((1u << shift) - 1);
+    const auto middle = 1u << (shift - 1);
+    return sign | static_cast<uint16_t>(half + (middle < rest || (rest == middle && (half & 1))));
+  }
+  const auto half = static_cast<uint32_t>(halfExponent << 10) | (mantissa >> 13);
+  const auto rest = mantissa & 0x1fff;
+  // carry from mantissa into exponent gives correct result, including overflow to infinity
+  return sign | static_cast<uint16_t>(half + (0x1000 < rest || (rest == 0x1000 && (half & 1))));
+}
+
+bool operator<(const Half& left, const Half& right) { return halfToFloat(left.bits) < halfToFloat(right.bits); }
+
+template <typename T>
+float decode(T value);
+template <typename T>
+T encode(float value);
+
+template <>
+float decode(float value) {
+  return value;
+}
+template <>
+float encode(float value) {
+  return value;
+}
+
+template <>
+float decode(Half value) {
+  return halfToFloat(value.bits);
+}
+template <>
+Half encode(float value) {
+  return {floatToHalf(value)};
+}
+
+template <>
+float decode(int16_t value) {
+  return value * INT16_STEP;
+}
+template <>
+int16_t encode(float value) {
+  return static_cast<int16_t>(std::nearbyint(std::clamp(value / INT16_STEP, -32768.0f, 32767.0f)));
+}
+
+template <>
+float decode(int8_t value) {
+  return value * INT8_STEP;
+}
+template <>
+int8_t encode(float value) {
+  return static_cast<int8_t>(std::nearbyint(std::clamp(value / INT8_STEP, -128.0f, 127.0f)));
+}
+
+size_t getItemSize(Averager::Precision precision) {
+  switch (precision) {
+    case Averager::Precision::Float16:
+      return sizeof(Half);
+    case Averager::Precision::Int16:
+      return sizeof(int16_t);
+    case Averager::Precision::Int8:
+      return sizeof(int8_t);
+    default:
+      return sizeof(float);
+  }
+}
+
+}  // namespace
+
+Averager::Averager(int size, int groupSize, Precision precision)
+    : m_size(size),
+      m_groupSize(groupSize),
+      m_precision(precision),
+      m_sum(size, 0.0),
+      m_average(size, 0.0),
+      m_history(static_cast<size_t>(size) * groupSize * getItemSize(precision), 0),
+      m_oldest(0),
+      m_frames(0) {
   updateAverage();
 }
 
 void Averager::push(const float* data) {
   m_frames = std::min(m_frames + 1, m_groupSize);
-  Buffer buffer = std::move(m_buffers.front());
-  subtract(buffer.data());
-  m_buffers.pop_front();
-
-  std::memcpy(buffer.data(), data, sizeof(float) * m_size);
-  add(buffer.data());
-  m_buffers.push_back(std::move(buffer));
-
+  const auto offset = static_cast<size_t>(m_oldest) * m_size;
+  switch (m_precision) {
+    case Precision::Float32:
+      push(reinterpret_cast<float*>(m_history.data()) + offset, data);
+      break;
+    case Precision::Float16:
+      push(reinterpret_cast<Half*>(m_history.data()) + offset, data);
+      break;
+    case Precision::Int16:
+      push(reinterpret_cast<int16_t*>(m_history.data()) + offset, data);
+      break;
+    case Precision::Int8:
+      push(reinterpret_cast<int8_t*>(m_history.data()) + offset, data);
+      break;
+  }
+  m_oldest = (m_oldest + 1) % m_groupSize;
   updateAverage();
 }
 
+// replaces oldest frame, encoding and sum update are done in single pass
+template <typename T>
+void Averager::push(T* frame, const float* data) {
+  for (int i = 0; i < m_size; ++i) {
+    const auto value = encode<T>(data[i]);
+    m_sum[i] = m_sum[i] - decode(frame[i]) + decode(value);
+    frame[i] = value;
+  }
+}
+
 void Averager::reset() {
   std::fill(m_sum.begin(), m_sum.end(), 0);
-  for (auto& buffer : m_buffers) {
-    std::fill(buffer.begin(), buffer.end(), 0);
-  }
+  std::fill(m_history.begin(), m_history.end(), 0);
+  m_oldest = 0;
   m_frames = 0;
   updateAverage();
 }
 
 const std::vector<float>& Averager::average() const { return m_average; }
 
-const std::deque<Averager::Buffer>& Averager::data() const { return m_buffers; }
+std::deque<Averager::Buffer> Averager::data() const {
+  std::deque<Buffer> buffers;
+  for (int frame = 0; frame < m_groupSize; ++frame) {
+    Buffer buffer(m_size);
+    for (int i = 0; i < m_size; ++i) {
+      buffer[i] = get(frame, i);
+    }
+    buffers.push_back(std::move(buffer));
+  }
+  return buffers;
+}
 
-void Averager::add(const float* data) {
-  for (int i = 0; i < m_size; ++i) {
-    m_sum[i] += data[i];
+int Averager::frames() const { return m_groupSize; }
+
+int Averager::getMaxIndex(int frame, int index, int groupSize) const {
+  switch (m_precision) {
+    case Precision::Float16:
+      return ::getMaxIndex(getFrame<Half>(frame), m_size, index, groupSize);
+    case Precision::Int16:
+      return ::getMaxIndex(getFrame<int16_t>(frame), m_size, index, groupSize);
+    case Precision::Int8:
+      return ::getMaxIndex(getFrame<int8_t>(frame), m_size, index, groupSize);
+    default:
+      return ::getMaxIndex(getFrame<float>(frame), m_size, index, groupSize);
   }
 }
 
-void Averager::subtract(const float* data) {
-  for (int i = 0; i < m_size; ++i) {
-    m_sum[i] -= data[i];
+float Averager::get(int frame, int index) const {
+  switch (m_precision) {
+    case Precision::Float16:
+      return decode(getFrame<Half>(frame)[index]);
+    case Precision::Int16:
+      return decode(getFrame<int16_t>(frame)[index]);
+    case Precision::Int8:
+      return decode(getFrame<int8_t>(frame)[index]);
+    default:
+      return decode(getFrame<float>(frame)[index]);
+  }
+}
+
+Averager::Precision Averager::parsePrecision(const std::string& name) {
+  if (name == "float16") {
+    return Precision::Float16;
+  } else if (name == "int16") {
+    return Precision::Int16;
+  } else if (name == "int8") {
+    return Precision::Int8;
   }
+  return Precision::Float32;
 }
 
 void Averager::updateAverage() {
@@ -58,4 +233,4 @@ void Averager::updateAverage() {
   } else {
     setNoData(m_average.data(), m_size);
   }
-}
\ No newline at end of file
+}
@@ -1,29 +1,52 @@
 #pragma once
 
 #include <radio/help_structures.h>
+#include <utils/collection_utils.h>
 
+#include <cstdint>
 #include <deque>
+#include <string>
 #include <vector>
 
+// moving average of last group size frames, sums are kept in float
+// history may be stored in reduced precision, values are rounded when pushed and average is computed from rounded values
 class Averager {
   using Buffer = std::vector<float>;
 
  public:
-  Averager(int size, int groupSize);
+  enum class Precision { Float32, Float16, Int16, Int8 };
+
+  Averager(int size, int groupSize, Precision precision = Precision::Float32);
   void push(const float* data);
   void reset();
   const std::vector<float>& average() const;
-  const std::deque<Buffer>& data() const;
+  // decoded history from oldest to newest, copies all frames
+  std::deque<Buffer> data() const;
+  int frames() const;
+  // max index around index in frame, rounding keeps order of values so no decoding is needed
+  int getMaxIndex(int frame, int index, int groupSize) const;
+  float get(int frame, int index) const;
+
+  static Precision parsePrecision(const std::string& name);
 
  private:
-  void add(const float* data);
-  void subtract(const float* data);
+  template <typename T>
+  void push(T* frame, const float* data);
+  template <typename T>
+  const T* getFrame(int frame) const;
   void updateAverage();
 
   const int m_size;
   const int m_groupSize;
+  const Precision m_precision;
   std::vector<float> m_sum;
   std::vector<float> m_average;
-  std::deque<Buffer> m_buffers;
+  std::vector<uint8_t> m_history;
+  int m_oldest;
   int m_frames;
-};
\ No newline at end of file
+};
+
+template <typename T>
+const T* Averager::getFrame(int frame) const {
+  return reinterpret_cast<const T*>(m_history.data()) + static_cast<size_t>((m_oldest + frame) % m_groupSize) * m_size;
+}
@@ -0,0 +1,100 @@
+#include "block_metrics.h"
+
+#include <config.h>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/buffer.h>
+#include <gnuradio/buffer_reader.h>
+#include <logger.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+constexpr auto LABEL = "performance";
+constexpr auto DEVICE_RANGE = "all";  // range label of device wide blocks
+
+namespace {
+Gauge& quantile(MetricLabels labels, const std::string& quantile) {
+  labels.emplace_back("quantile", quantile);
+  return Metrics::gauge("sdr_block_latency_seconds", "block work latency percentiles over last report interval", labels);
+}
+
+double toMilliseconds(uint64_t nanoseconds) { return nanoseconds / 1e6; }
+}  // namespace
+
+BlockMetrics::BlockMetrics(const std::string& block, const Device& device)
+    : BlockMetrics(fmt::format("{} {}", device.getName(), block), {{"device", device.getName()}, {"block", block}, {"range", DEVICE_RANGE}}) {}
+
+BlockMetrics::BlockMetrics(const std::string& block, const Device& device, const FrequencyRange& frequencyRange)
+    : BlockMetrics(
+          fmt::format("{} {} {}-{}", device.getName(), block, frequencyRange.start, frequencyRange.stop),
+          {{"device", device.getName()}, {"block", block}, {"range", fmt::format("{}-{}", frequencyRange.start, frequencyRange.stop)}}) {}
+
+BlockMetrics::BlockMetrics(const std::string& name, const MetricLabels& labels)
+    : m_block(name),
+      m_latency(latency(name)),
+      m_items(Metrics::counter("sdr_block_items_total", "items processed by block", labels)),
+      m_workTime(Metrics::histogram("sdr_block_work_seconds", "block work call duration", labels)),
+      m_bufferFill(Metrics::gauge("sdr_block_input_buffer_fill", "block input buffer fill ratio", labels)),
+      m_p50(quantile(labels, "0.5")),
+      m_p99(quantile(labels, "0.99")),
+      m_p999(quantile(labels, "0.999")),
+      m_max(quantile(labels, "1")) {}
+
+BlockMetrics::Timer BlockMetrics::work(const gr::block& block, int items) {
+  m_items.inc(items);
+  m_latency.reportItems.fetch_add(items, std::memory_order_relaxed);
+  const auto detail = block.detail();
+  if (detail && 0 < detail->ninputs()) {
+    const auto reader = detail->input(0);
+    m_bufferFill.set(static_cast<double>(reader->items_available()) / reader->buffer()->bufsize());
+  }
+  return Timer(*this);
+}
+
+BlockMetrics::Timer BlockMetrics::measure() { return Timer(*this); }
+
+void BlockMetrics::record(const std::chrono::nanoseconds& duration) {
+  m_workTime.observe(std::chrono::duration<double>(duration).count());
+  m_latency.histogram.record(duration.count());
+  const auto now = std::chrono::steady_clock::now();
+  auto lastReportTime = m_latency.lastReportTime.load(std::memory_order_relaxed);
+  const auto last = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(lastReportTime));
+  // only one of instances sharing latency wins the report
+  if (last + LATENCY_REPORT_INTERVAL <= now && m_latency.lastReportTime.compare_exchange_strong(lastReportTime, now.time_since_epoch().count(), std::memory_order_relaxed)) {
+    report(now, last);
+  }
+}
+
+BlockMetrics::Latency& BlockMetrics::latency(const std::string& name) {
+  static std::mutex mutex;
+  static std::map<std::string, std::unique_ptr<Latency>> latencies;
+  std::unique_lock<std::mutex> lock(mutex);
+  auto& latency = latencies[name];
+  if (!latency) {
+    latency = std::make_unique<Latency>();
+    latency->lastReportTime = std::chrono::steady_clock::now().time_since_epoch().count();
+    latency->reportItems = 0;
+  }
+  return *latency;
+}
+
+void BlockMetrics::report(const std::chrono::steady_clock::time_point& now, const std::chrono::steady_clock::time_point& lastReportTime) {
+  const auto snapshot = m_latency.histogram.snapshot(true);
+  const auto items = m_latency.reportItems.exchange(0, std::memory_order_relaxed);
+  const auto seconds = std::chrono::duration<double>(now - lastReportTime).count();
+  Logger::debug(
+      LABEL,
+      "{}, calls: {}, items/s: {:.1f}, p50: {:.3f} ms, p99: {:.3f} ms, p99.9: {:.3f} ms, max: {:.3f} ms",
+      m_block,
+      snapshot.count,
+      items / seconds,
+      toMilliseconds(snapshot.p50),
+      toMilliseconds(snapshot.p99),
+      toMilliseconds(snapshot.p999),
+      toMilliseconds(snapshot.max));
+  m_p50.set(snapshot.p50 / 1e9);
+  m_p99.set(snapshot.p99 / 1e9);
+  m_p999.set(snapshot.p999 / 1e9);
+  m_max.set(snapshot.max / 1e9);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <gnuradio/block.h>
+#include <latency_histogram.h>
+#include <metrics.h>
+#include <radio/help_structures.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// per block work latency (prometheus histogram and hdr percentiles), processed items and input buffer fill
+class BlockMetrics {
+ public:
+  class Timer {
+   public:
+    explicit Timer(BlockMetrics& metrics) : m_metrics(metrics), m_start(std::chrono::steady_clock::now()) {}
+    ~Timer() { m_metrics.record(std::chrono::steady_clock::now() - m_start); }
+
+   private:
+    BlockMetrics& m_metrics;
+    const std::chrono::steady_clock::time_point m_start;
+  };
+
+  // blocks of device wide flowgraph
+  BlockMetrics(const std::string& block, const Device& device);
+  // blocks of processor, range label keeps processors of same device apart
+  BlockMetrics(const std::string& block, const Device& device, const FrequencyRange& frequencyRange);
+
+  // call at the beginning of work, returned timer records work duration when destroyed
+  Timer work(const gr::block& block, int items);
+  // latency only, for code running outside of gnuradio scheduler
+  Timer measure();
+  // externally measured latency, e.g. sample age
+  void record(const std::chrono::nanoseconds& duration);
+
+ private:
+  // shared by instances with same labels (e.g. buffers of parallel recorders), so they are aggregated and reported once
+  struct Latency {
+    LatencyHistogram histogram;
+    std::atomic<std::chrono::steady_clock::rep> lastReportTime;
+    std::atomic<uint64_t> reportItems;
+  };
+
+  BlockMetrics(const std::string& name, const MetricLabels& labels);
+
+  static Latency& latency(const std::string& name);
+  void report(const std::chrono::steady_clock::time_point& now, const std::chrono::steady_clock::time_point& lastReportTime);
+
+  const std::string m_block;
+  Latency& m_latency;
+  Counter& m_items;
+  Histogram& m_workTime;
+  Gauge& m_bufferFill;
+  Gauge& m_p50;
+  Gauge& m_p99;
+  Gauge& m_p999;
+  Gauge& m_max;
+};
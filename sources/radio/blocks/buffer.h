@@ -1,6 +1,8 @@
 #pragma once
 
 #include <gnuradio/sync_block.h>
+#include <radio/blocks/block_metrics.h>
+#include <radio/blocks/sample_time.h>
 #include <utils/utils.h>
 
 #include <cstdint>
@@ -12,14 +14,22 @@
 template <typename T>
 class Buffer : public gr::sync_block {
  public:
-  Buffer(const std::string& name, const int itemSize) : gr::sync_block(name, gr::io_signature::make(1, 1, sizeof(T) * itemSize), gr::io_signature::make(0, 0, 0)), m_itemSize(itemSize), m_count(0) {}
+  Buffer(const std::string& name, const Device& device, const int itemSize, const double itemRate)
+      : gr::sync_block(name, gr::io_signature::make(1, 1, sizeof(T) * itemSize), gr::io_signature::make(0, 0, 0)),
+        m_itemSize(itemSize),
+        m_sampleTime(itemRate),
+        m_metrics(name, device),
+        m_count(0) {}
 
   int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star&) {
-    push(static_cast<const T*>(input_items[0]), noutput_items);
+    const auto timer = m_metrics.work(*this, noutput_items);
+    std::vector<gr::tag_t> tags;
+    get_tags_in_window(tags, 0, 0, noutput_items, rxTimeTag());
+    push(static_cast<const T*>(input_items[0]), noutput_items, tags, nitems_read(0));
     return noutput_items;
   }
 
-  void push(const T* data, const int count) {
+  void push(const T* data, const int count, const std::vector<gr::tag_t>& tags, const uint64_t offset) {
     std::unique_lock<std::mutex> lock(m_mutex);
     if (count == 0) {
       return;
@@ -32,8 +42,9 @@ class Buffer : public gr::sync_block {
       m_samplesTime.resize(newCount);
     }
     memcpy(m_data.data() + m_count * m_itemSize, data, count * m_itemSize * sizeof(T));
+    m_sampleTime.update(tags, offset);
     for (int i = 0; i < count; ++i) {
-      m_samplesTime[m_count + i] = getTime();
+      m_samplesTime[m_count + i] = m_sampleTime.get(offset + i);
     }
     m_count += count;
   }
@@ -61,6 +72,8 @@ class Buffer : public gr::sync_block {
 
  private:
   const int m_itemSize;
+  SampleTime m_sampleTime;
+  BlockMetrics m_metrics;
   std::mutex m_mutex;
   std::vector<T> m_data;
   std::vector<std::chrono::milliseconds> m_samplesTime;
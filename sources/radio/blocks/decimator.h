@@ -1,16 +1,21 @@
 #pragma once
 
 #include <gnuradio/sync_block.h>
+#include <radio/blocks/block_metrics.h>
 
 template <typename T>
 class Decimator : virtual public gr::sync_block {
  public:
-  Decimator(int itemSize, int ratio)
-      : gr::sync_block("Decimator", gr::io_signature::make(1, 1, sizeof(T) * itemSize * ratio), gr::io_signature::make(1, 1, sizeof(T) * itemSize)), m_itemSize(itemSize), m_ratio(ratio) {}
+  Decimator(const Device& device, const FrequencyRange& frequencyRange, int itemSize, int ratio)
+      : gr::sync_block("Decimator", gr::io_signature::make(1, 1, sizeof(T) * itemSize * ratio), gr::io_signature::make(1, 1, sizeof(T) * itemSize)),
+        m_itemSize(itemSize),
+        m_ratio(ratio),
+        m_metrics("Decimator", device, frequencyRange) {}
 
   int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) override {
     const T* in = static_cast<const T*>(input_items[0]);
     T* out = static_cast<T*>(output_items[0]);
+    const auto timer = m_metrics.work(*this, noutput_items);
 
     for (int i = 0; i < noutput_items; ++i) {
       decimate(&in[i * m_itemSize * m_ratio], &out[i * m_itemSize]);
@@ -23,4 +28,5 @@ class Decimator : virtual public gr::sync_block {
 
   const int m_itemSize;
   const int m_ratio;
+  BlockMetrics m_metrics;
 };
@@ -0,0 +1,24 @@
+#include "fft.h"
+
+#include <logger.h>
+
+constexpr auto LABEL = "fft";
+constexpr auto WISDOM_FILE = "fftw_wisdom";
+
+void Fft::prepare(const Config& config, int fftSize, int batchSize) { FftPlan::prepare(config.workDir() + "/" + WISDOM_FILE, fftSize, batchSize, config.fftThreads()); }
+
+Fft::Fft(const Config& config, const Device& device, const FrequencyRange& frequencyRange, int fftSize, const std::vector<float>& window, int batchSize)
+    : gr::sync_block("Fft", gr::io_signature::make(1, 1, sizeof(gr_complex) * fftSize), gr::io_signature::make(1, 1, sizeof(gr_complex) * fftSize)),
+      m_metrics("Fft", device, frequencyRange),
+      m_plan(fftSize, window, batchSize, config.fftThreads()) {
+  Logger::info(LABEL, "fft: {}, batch: {}, threads: {}", colored(GREEN, "{}", fftSize), colored(GREEN, "{}", batchSize), colored(GREEN, "{}", config.fftThreads()));
+}
+
+int Fft::work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) {
+  const gr_complex* input_buf = static_cast<const gr_complex*>(input_items[0]);
+  gr_complex* output_buf = static_cast<gr_complex*>(output_items[0]);
+  const auto timer = m_metrics.work(*this, noutput_items);
+
+  m_plan.transform(input_buf, output_buf, noutput_items);
+  return noutput_items;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <config.h>
+#include <gnuradio/sync_block.h>
+#include <radio/blocks/block_metrics.h>
+#include <radio/fft_plan.h>
+#include <radio/help_structures.h>
+
+#include <vector>
+
+// windowed forward fft with output shift, replaces fft_v for detection
+class Fft : virtual public gr::sync_block {
+ public:
+  // measures missing plans into wisdom stored in work dir, call before flowgraph lock
+  static void prepare(const Config& config, int fftSize, int batchSize);
+
+  Fft(const Config& config, const Device& device, const FrequencyRange& frequencyRange, int fftSize, const std::vector<float>& window, int batchSize);
+
+  int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) override;
+
+ private:
+  BlockMetrics m_metrics;
+  FftPlan m_plan;
+};
@@ -0,0 +1,21 @@
+#include "iq_corrector.h"
+
+#include <config.h>
+
+IqCorrector::IqCorrector(const Device& device, Frequency sampleRate)
+    : gr::sync_block("IqCorrector", gr::io_signature::make(1, 1, sizeof(gr_complex)), gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      m_timeConstant(std::chrono::duration<double>(IQ_CORRECTION_TIME).count() * sampleRate),
+      m_metrics("IqCorrector", device),
+      m_frequency(0) {}
+
+void IqCorrector::setFrequency(Frequency frequency) { m_frequency.store(frequency); }
+
+int IqCorrector::work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) {
+  const gr_complex* input_buf = static_cast<const gr_complex*>(input_items[0]);
+  gr_complex* output_buf = static_cast<gr_complex*>(output_items[0]);
+  const auto timer = m_metrics.work(*this, noutput_items);
+
+  auto it = m_corrections.try_emplace(m_frequency.load(), m_timeConstant).first;
+  it->second.process(input_buf, output_buf, noutput_items);
+  return noutput_items;
+}
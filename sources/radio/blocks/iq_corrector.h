@@ -0,0 +1,24 @@
+#pragma once
+
+#include <gnuradio/sync_block.h>
+#include <radio/blocks/block_metrics.h>
+#include <radio/help_structures.h>
+#include <radio/iq_correction.h>
+
+#include <atomic>
+#include <map>
+
+// removes dc offset and iq imbalance of source, correction state is kept per tuned frequency and reused after retune
+class IqCorrector : virtual public gr::sync_block {
+ public:
+  IqCorrector(const Device& device, Frequency sampleRate);
+
+  void setFrequency(Frequency frequency);
+  int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) override;
+
+ private:
+  const double m_timeConstant;
+  BlockMetrics m_metrics;
+  std::atomic<Frequency> m_frequency;
+  std::map<Frequency, IqCorrection> m_corrections;
+};
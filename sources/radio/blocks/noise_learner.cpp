@@ -2,6 +2,8 @@
 
 #include <config.h>
 #include <logger.h>
+#include <radio/blocks/sample_time.h>
+#include <tracer.h>
 #include <utils/utils.h>
 
 constexpr auto LABEL = "noise";
@@ -27,24 +29,44 @@ bool NoiseLearner::Noise::add(const float* data, const int size) {
   return false;
 }
 
-NoiseLearner::NoiseLearner(int itemSize, std::function<Frequency()> getFrequency, std::function<Frequency(const int index)> indexToFrequency)
+NoiseLearner::NoiseLearner(const Device& device, const FrequencyRange& frequencyRange, int itemSize, std::function<Frequency()> getFrequency, std::function<Frequency(const int index)> indexToFrequency)
     : gr::sync_block("NoiseLearner", gr::io_signature::make(1, 1, sizeof(float) * itemSize), gr::io_signature::make(1, 1, sizeof(float) * itemSize)),
       m_itemSize(itemSize),
       m_getFrequency(getFrequency),
-      m_indexToFrequency(indexToFrequency) {}
+      m_indexToFrequency(indexToFrequency),
+      m_metrics("NoiseLearner", device, frequencyRange) {}
 
 int NoiseLearner::work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) {
   const float* input_buf = static_cast<const float*>(input_items[0]);
   float* output_buf = static_cast<float*>(output_items[0]);
+  const auto timer = m_metrics.work(*this, noutput_items);
+
+  std::vector<gr::tag_t> discontinuities;
+  get_tags_in_window(discontinuities, 0, 0, noutput_items, discontinuityTag());
+  auto discontinuity = discontinuities.begin();
 
   std::unique_lock<std::mutex> lock(m_mutex);
   const auto frequency = m_getFrequency();
+  if (m_noise.count(frequency) == 0) {
+    Tracer::asyncBegin("noise learning", frequency);
+  }
   auto& noise = m_noise[frequency];
   for (int i = 0; i < noutput_items; ++i) {
     const auto fitIndex = i * m_itemSize;
+    if (discontinuity != discontinuities.end() && discontinuity->offset <= nitems_read(0) + i) {
+      // learning window must cover continuous samples, learned threshold is kept
+      if (!noise.m_isReady) {
+        Logger::info(LABEL, "samples lost, learning restarted, frequency: {}", formatFrequency(frequency));
+        noise = Noise();
+      }
+      while (discontinuity != discontinuities.end() && discontinuity->offset <= nitems_read(0) + i) {
+        discontinuity++;
+      }
+    }
     if (!noise.m_isReady) {
       if (noise.add(&input_buf[fitIndex], m_itemSize)) {
         Logger::info(LABEL, "learning completed, frequency: {}", formatFrequency(frequency));
+        Tracer::asyncEnd("noise learning", frequency);
       }
       setNoData(&output_buf[fitIndex], m_itemSize);
       continue;
@@ -58,9 +80,11 @@ int NoiseLearner::work(int noutput_items, gr_vector_const_void_star& input_items
       }
     }
 
-    const auto frequency = m_indexToFrequency(maxIndex);
-    const auto maxValue = output_buf[fitIndex + maxIndex];
-    Logger::trace(LABEL, "best signal, frequency: {}, power: {}", formatFrequency(frequency), formatPower(maxValue));
+    if (Logger::isEnabled(spdlog::level::trace)) {
+      const auto frequency = m_indexToFrequency(maxIndex);
+      const auto maxValue = output_buf[fitIndex + maxIndex];
+      Logger::trace(LABEL, "best signal, frequency: {}, power: {}", formatFrequency(frequency), formatPower(maxValue));
+    }
   }
 
   return noutput_items;
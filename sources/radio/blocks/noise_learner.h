@@ -1,6 +1,7 @@
 #pragma once
 
 #include <gnuradio/sync_block.h>
+#include <radio/blocks/block_metrics.h>
 #include <radio/help_structures.h>
 
 #include <functional>
@@ -20,7 +21,7 @@ class NoiseLearner : virtual public gr::sync_block {
   };
 
  public:
-  NoiseLearner(const int itemSize, std::function<Frequency()> getFrequency, std::function<Frequency(const int index)> indexToFrequency);
+  NoiseLearner(const Device& device, const FrequencyRange& frequencyRange, const int itemSize, std::function<Frequency()> getFrequency, std::function<Frequency(const int index)> indexToFrequency);
 
   int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) override;
 
@@ -28,6 +29,7 @@ class NoiseLearner : virtual public gr::sync_block {
   const int m_itemSize;
   const std::function<Frequency()> m_getFrequency;
   const std::function<Frequency(const int index)> m_indexToFrequency;
+  BlockMetrics m_metrics;
   std::mutex m_mutex;
   std::map<Frequency, Noise> m_noise;
 };
\ No newline at end of file
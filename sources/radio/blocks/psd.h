@@ -1,17 +1,17 @@
 #pragma once
 
 #include <gnuradio/sync_block.h>
-#include <performance_logger.h>
+#include <radio/blocks/block_metrics.h>
 #include <radio/help_structures.h>
 
 class PSD : virtual public gr::sync_block {
  public:
-  PSD(int itemSize, Frequency sample_rate);
+  PSD(const Device& device, const FrequencyRange& frequencyRange, int itemSize, Frequency sample_rate);
 
   int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) override;
 
  private:
-  PerformanceLogger m_performanceLogger;
+  BlockMetrics m_metrics;
   const int m_itemSize;
   const Frequency m_sampleRate;
 };
@@ -0,0 +1,42 @@
+#include "sample_time.h"
+
+pmt::pmt_t rxTimeTag() {
+  static const auto tag = pmt::intern("rx_time");
+  return tag;
+}
+
+pmt::pmt_t discontinuityTag() {
+  static const auto tag = pmt::intern("rx_discontinuity");
+  return tag;
+}
+
+pmt::pmt_t toRxTime(const std::chrono::nanoseconds& time) {
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(time);
+  const auto fraction = std::chrono::duration<double>(time - seconds).count();
+  return pmt::make_tuple(pmt::from_uint64(seconds.count()), pmt::from_double(fraction));
+}
+
+std::chrono::nanoseconds fromRxTime(const pmt::pmt_t& value) {
+  const auto seconds = std::chrono::seconds(pmt::to_uint64(pmt::tuple_ref(value, 0)));
+  const auto fraction = std::chrono::duration<double>(pmt::to_double(pmt::tuple_ref(value, 1)));
+  return seconds + std::chrono::duration_cast<std::chrono::nanoseconds>(fraction);
+}
+
+SampleTime::SampleTime(double itemRate) : m_itemRate(itemRate), m_hasTag(false), m_offset(0), m_time(0) {}
+
+void SampleTime::update(const std::vector<gr::tag_t>& tags, uint64_t offset) {
+  if (!tags.empty()) {
+    m_hasTag = true;
+    m_offset = tags.back().offset;
+    m_time = fromRxTime(tags.back().value);
+  } else if (!m_hasTag) {
+    m_offset = offset;
+    m_time = std::chrono::system_clock::now().time_since_epoch();
+  }
+}
+
+std::chrono::milliseconds SampleTime::get(uint64_t offset) const {
+  const auto items = static_cast<double>(static_cast<int64_t>(offset - m_offset));
+  const auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(items / m_itemRate));
+  return std::chrono::duration_cast<std::chrono::milliseconds>(m_time + delta);
+}
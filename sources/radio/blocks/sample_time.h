@@ -0,0 +1,31 @@
+#pragma once
+
+#include <gnuradio/block.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// stream tag with time of first sample in buffer, gnuradio rx_time format (full seconds, fractional seconds)
+pmt::pmt_t rxTimeTag();
+pmt::pmt_t toRxTime(const std::chrono::nanoseconds& time);
+std::chrono::nanoseconds fromRxTime(const pmt::pmt_t& value);
+
+// stream tag on first sample after lost samples (overflow, stream restart)
+pmt::pmt_t discontinuityTag();
+
+// converts absolute item offset to time based on latest rx_time tag and items rate
+// falls back to system clock, read once per buffer, until first tag is received
+class SampleTime {
+ public:
+  explicit SampleTime(double itemRate);
+
+  void update(const std::vector<gr::tag_t>& tags, uint64_t offset);
+  std::chrono::milliseconds get(uint64_t offset) const;
+
+ private:
+  const double m_itemRate;
+  bool m_hasTag;
+  uint64_t m_offset;
+  std::chrono::nanoseconds m_time;
+};
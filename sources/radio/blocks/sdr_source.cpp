@@ -2,27 +2,48 @@
 
 #include <SoapySDR/Formats.h>
 #include <logger.h>
+#include <radio/blocks/sample_time.h>
+#include <utils/thread_utils.h>
 #include <utils/utils.h>
 
 #include <SoapySDR/Errors.hpp>
+#include <thread>
 
 constexpr auto LABEL = "source";
+constexpr auto MAX_TIME_DRIFT = std::chrono::seconds(1);                 // resync hardware time with system clock if drift is bigger
+constexpr auto MAX_CONSECUTIVE_TIMEOUTS = 10;                            // restart stream after n read timeouts in a row
+constexpr auto OVERFLOW_LOG_INTERVAL = std::chrono::seconds(10);         // print overflow warning at most every n
+constexpr auto RECOVERY_BACKOFF = std::chrono::milliseconds(1000);       // first device reopen delay, doubled every attempt
+constexpr auto RECOVERY_MAX_BACKOFF = std::chrono::milliseconds(30000);  // maximal device reopen delay
+constexpr auto RECOVERY_POLL_INTERVAL = std::chrono::milliseconds(100);  // work sleep while waiting for next recovery attempt
+constexpr auto MIN_STREAM_MTU = static_cast<size_t>(1024);               // max output items when device is not available
 
-SdrSource::SdrSource(const Device& device)
-    : gr::sync_block("SdrSource", gr::io_signature::make(0, 0, 0), gr::io_signature::make(1, 1, sizeof(gr_complex))), m_configDevice(device), m_device(nullptr), m_stream(nullptr) {
-  m_device = SoapySDR::Device::make(fmt::format("driver={},serial={}", device.driver, device.serial));
-  m_device->setGainMode(SOAPY_SDR_RX, 0, false);
-  for (const auto& gain : device.gains) {
-    Logger::info(LABEL, "set gain, name: {}, value: {}", colored(GREEN, "{}", gain.name), colored(GREEN, "{}", gain.value));
-    m_device->setGain(SOAPY_SDR_RX, 0, gain.name.c_str(), gain.value);
-  }
-  Logger::info(LABEL, "sample rate: {}", formatFrequency(device.sample_rate));
-  m_device->setSampleRate(SOAPY_SDR_RX, 0, device.sample_rate);
+SdrSource::SdrSource(const Device& device, int priority)
+    : gr::sync_block("SdrSource", gr::io_signature::make(0, 0, 0), gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      m_configDevice(device),
+      m_priority(priority),
+      m_isThreadConfigured(false),
+      m_device(nullptr),
+      m_stream(nullptr),
+      m_frequency(0),
+      m_hasTimeOffset(false),
+      m_timeOffset(0),
+      m_isDiscontinuity(false),
+      m_consecutiveTimeouts(0),
+      m_recoveryAttempts(0),
+      m_nextRecoveryTime(0),
+      m_lastOverflowLogTime(0),
+      m_samples(Metrics::counter("sdr_source_samples_total", "samples read from device", {{"device", device.getName()}})),
+      m_overflows(Metrics::counter("sdr_source_overflows_total", "device stream overflows", {{"device", device.getName()}})),
+      m_timeouts(Metrics::counter("sdr_source_timeouts_total", "device stream read timeouts", {{"device", device.getName()}})),
+      m_streamErrors(Metrics::counter("sdr_source_stream_errors_total", "device stream errors", {{"device", device.getName()}})),
+      m_recoveries(Metrics::counter("sdr_source_recoveries_total", "device stream recovery attempts", {{"device", device.getName()}})) {
+  openDevice();
 }
 
 SdrSource::~SdrSource() {
   stop();
-  SoapySDR::Device::unmake(m_device);
+  closeDevice();
 }
 
 int SdrSource::work(int noutput_items, gr_vector_const_void_star&, gr_vector_void_star& output_items) {
@@ -30,15 +51,63 @@ int SdrSource::work(int noutput_items, gr_vector_const_void_star&, gr_vector_voi
   long long int time_ns = 0;
   const long timeout_us = 500000;  // 0.5 sec
 
-  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_isThreadConfigured) {
+    // usb reader thread must not be preempted by recorders, otherwise device buffers overflow
+    m_isThreadConfigured = true;
+    if (0 < m_priority && !setThreadRealtimePriority(m_priority)) {
+      Logger::warn(LABEL, "set realtime priority failed, missing CAP_SYS_NICE or rtprio limit");
+    } else if (0 < m_priority) {
+      Logger::info(LABEL, "realtime priority: {}", colored(GREEN, "{}", m_priority));
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (!m_stream && !recover()) {
+    lock.unlock();
+    std::this_thread::sleep_for(RECOVERY_POLL_INTERVAL);
+    return 0;
+  }
+
   const auto result = m_device->readStream(m_stream, output_items.data(), noutput_items, flags, time_ns, timeout_us);
   if (0 <= result) {
+    if (flags & SOAPY_SDR_END_ABRUPT) {
+      Logger::warn(LABEL, "stream ended abruptly");
+      m_isDiscontinuity = true;
+    }
+    if (0 < result) {
+      m_samples.inc(result);
+      m_consecutiveTimeouts = 0;
+      m_recoveryAttempts = 0;
+      add_item_tag(0, nitems_written(0), rxTimeTag(), toRxTime(getBufferTime(flags, time_ns, result)));
+      if (m_isDiscontinuity) {
+        add_item_tag(0, nitems_written(0), discontinuityTag(), pmt::PMT_T);
+        m_isDiscontinuity = false;
+      }
+    }
     return result;
-  } else {
-    Logger::error(LABEL, "soapy error: {}", SoapySDR::errToStr(result));
-    exit(1);
+  }
+
+  if (result == SOAPY_SDR_OVERFLOW) {
+    m_overflows.inc();
+    m_isDiscontinuity = true;
+    const auto now = getTime();
+    if (m_lastOverflowLogTime + OVERFLOW_LOG_INTERVAL <= now) {
+      Logger::warn(LABEL, "stream overflow, total: {}", colored(RED, "{}", m_overflows.value()));
+      m_lastOverflowLogTime = now;
+    }
     return 0;
   }
+  if (result == SOAPY_SDR_TIMEOUT) {
+    m_timeouts.inc();
+    if (++m_consecutiveTimeouts < MAX_CONSECUTIVE_TIMEOUTS) {
+      return 0;
+    }
+  }
+  m_streamErrors.inc();
+  Logger::error(LABEL, "soapy error: {}, restarting stream", SoapySDR::errToStr(result));
+  closeStream();
+  m_consecutiveTimeouts = 0;
+  return 0;
 }
 
 int SdrSource::general_work(int noutput_items, gr_vector_int&, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) {
@@ -46,26 +115,35 @@ int SdrSource::general_work(int noutput_items, gr_vector_int&, gr_vector_const_v
   return work(noutput_items, input_items, output_items);
 }
 
+// device may be closed after failed recovery, reopening is left to work
 bool SdrSource::start() {
   std::lock_guard<std::mutex> lock(m_mutex);
-  m_stream = m_device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
-  set_max_noutput_items(std::max(static_cast<size_t>(1024), m_device->getStreamMTU(m_stream)));
-  m_device->activateStream(m_stream);
+  auto mtu = MIN_STREAM_MTU;
+  if (m_device) {
+    try {
+      openStream();
+      mtu = std::max(mtu, m_device->getStreamMTU(m_stream));
+    } catch (const std::exception& exception) {
+      Logger::exception(LABEL, exception, SPDLOG_LOC, "open stream failed");
+      closeStream();
+    }
+  }
+  set_max_noutput_items(mtu);
   return true;
 }
 
 bool SdrSource::stop() {
   std::lock_guard<std::mutex> lock(m_mutex);
-  if (m_stream) {
-    m_device->deactivateStream(m_stream);
-    m_device->closeStream(m_stream);
-    m_stream = nullptr;
-  }
+  closeStream();
   return true;
 }
 
 bool SdrSource::setCenterFrequency(Frequency frequency) {
   std::lock_guard<std::mutex> lock(m_mutex);
+  m_frequency = frequency;
+  if (!m_device) {
+    return false;
+  }
   for (int i = 0; i < 10; ++i) {
     try {
       m_device->setFrequency(SOAPY_SDR_RX, 0, frequency);
@@ -74,4 +152,85 @@ bool SdrSource::setCenterFrequency(Frequency frequency) {
     }
   }
   return false;
-}
\ No newline at end of file
+}
+
+void SdrSource::openDevice() {
+  m_device = SoapySDR::Device::make(fmt::format("driver={},serial={}", m_configDevice.driver, m_configDevice.serial));
+  m_device->setGainMode(SOAPY_SDR_RX, 0, false);
+  for (const auto& gain : m_configDevice.gains) {
+    Logger::info(LABEL, "set gain, name: {}, value: {}", colored(GREEN, "{}", gain.name), colored(GREEN, "{}", gain.value));
+    m_device->setGain(SOAPY_SDR_RX, 0, gain.name.c_str(), gain.value);
+  }
+  Logger::info(LABEL, "sample rate: {}", formatFrequency(m_configDevice.sample_rate));
+  m_device->setSampleRate(SOAPY_SDR_RX, 0, m_configDevice.sample_rate);
+  if (m_frequency) {
+    m_device->setFrequency(SOAPY_SDR_RX, 0, m_frequency);
+  }
+}
+
+void SdrSource::closeDevice() {
+  if (m_device) {
+    SoapySDR::Device::unmake(m_device);
+    m_device = nullptr;
+  }
+}
+
+void SdrSource::openStream() {
+  m_stream = m_device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+  m_device->activateStream(m_stream);
+  m_hasTimeOffset = false;
+}
+
+void SdrSource::closeStream() {
+  if (m_stream) {
+    try {
+      m_device->deactivateStream(m_stream);
+      m_device->closeStream(m_stream);
+    } catch (const std::exception& exception) {
+      Logger::exception(LABEL, exception, SPDLOG_LOC, "close stream failed");
+    }
+    m_stream = nullptr;
+  }
+}
+
+// first attempt restarts stream, next attempts reopen device with exponential backoff
+bool SdrSource::recover() {
+  const auto now = getTime();
+  if (now < m_nextRecoveryTime) {
+    return false;
+  }
+  m_recoveryAttempts++;
+  m_recoveries.inc();
+  m_nextRecoveryTime = now + std::min(RECOVERY_MAX_BACKOFF, RECOVERY_BACKOFF * (1 << std::min(m_recoveryAttempts - 1, 6)));
+  Logger::warn(LABEL, "recovering stream, attempt: {}", colored(RED, "{}", m_recoveryAttempts));
+  try {
+    if (1 < m_recoveryAttempts || !m_device) {
+      closeDevice();
+      openDevice();
+    }
+    openStream();
+    m_isDiscontinuity = true;
+    Logger::info(LABEL, "stream recovered");
+    return true;
+  } catch (const std::exception& exception) {
+    Logger::exception(LABEL, exception, SPDLOG_LOC, "recover stream failed, next attempt in: {} ms", (m_nextRecoveryTime - now).count());
+    closeStream();
+    return false;
+  }
+}
+
+// single system clock read per buffer, hardware time (if available) is mapped to system clock
+std::chrono::nanoseconds SdrSource::getBufferTime(int flags, long long int timeNs, int count) {
+  const auto duration = std::chrono::nanoseconds(static_cast<int64_t>(count * 1e9 / m_configDevice.sample_rate));
+  const auto systemTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()) - duration;
+  if (!(flags & SOAPY_SDR_HAS_TIME)) {
+    return systemTime;
+  }
+  const auto hardwareTime = std::chrono::nanoseconds(timeNs);
+  if (!m_hasTimeOffset || MAX_TIME_DRIFT < std::chrono::abs(hardwareTime + m_timeOffset - systemTime)) {
+    Logger::debug(LABEL, "hardware time synchronized, offset: {} ns", (systemTime - hardwareTime).count());
+    m_timeOffset = systemTime - hardwareTime;
+    m_hasTimeOffset = true;
+  }
+  return hardwareTime + m_timeOffset;
+}
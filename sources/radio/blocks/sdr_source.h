@@ -1,14 +1,16 @@
 #pragma once
 
 #include <gnuradio/sync_block.h>
+#include <metrics.h>
 #include <radio/help_structures.h>
 
 #include <SoapySDR/Device.hpp>
+#include <chrono>
 #include <mutex>
 
 class SdrSource : virtual public gr::sync_block {
  public:
-  SdrSource(const Device& device);
+  SdrSource(const Device& device, int priority);
   ~SdrSource();
 
   int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) override;
@@ -20,8 +22,30 @@ class SdrSource : virtual public gr::sync_block {
   bool setCenterFrequency(Frequency frequency);
 
  private:
+  void openDevice();
+  void closeDevice();
+  void openStream();
+  void closeStream();
+  bool recover();
+  std::chrono::nanoseconds getBufferTime(int flags, long long int timeNs, int count);
+
   const Device m_configDevice;
+  const int m_priority;
+  bool m_isThreadConfigured;
   std::mutex m_mutex;
   SoapySDR::Device* m_device;
   SoapySDR::Stream* m_stream;
+  Frequency m_frequency;
+  bool m_hasTimeOffset;
+  std::chrono::nanoseconds m_timeOffset;
+  bool m_isDiscontinuity;
+  int m_consecutiveTimeouts;
+  int m_recoveryAttempts;
+  std::chrono::milliseconds m_nextRecoveryTime;
+  std::chrono::milliseconds m_lastOverflowLogTime;
+  Counter& m_samples;
+  Counter& m_overflows;
+  Counter& m_timeouts;
+  Counter& m_streamErrors;
+  Counter& m_recoveries;
 };
\ No newline at end of file
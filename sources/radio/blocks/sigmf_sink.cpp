@@ -0,0 +1,208 @@
+#include "sigmf_sink.h"
+
+#include <logger.h>
+#include <utils/thread_utils.h>
+#include <utils/utils.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+
+constexpr auto LABEL = "sigmf";
+constexpr auto WRITE_BUFFER_SIZE = 4 * 1024 * 1024;
+constexpr auto DATA_EXTENSION = ".sigmf-data";
+constexpr auto META_EXTENSION = ".sigmf-meta";
+
+namespace {
+// sinks of all recorders share the directory, retention scans must not race
+std::mutex retentionMutex;
+
+std::string formatDateTime(const std::chrono::milliseconds& time) {
+  const time_t seconds = time.count() / 1000;
+  struct tm tm;
+  gmtime_r(&seconds, &tm);
+  return fmt::format(
+      "{:04d}-{:02d}-{:02d}T{:02d}:{:02d}:{:02d}.{:03d}Z", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(time.count() % 1000));
+}
+
+std::string getBaseName(const std::string& dir, const Device& device, const Recording& recording, const std::chrono::milliseconds& time) {
+  const time_t seconds = time.count() / 1000;
+  struct tm tm;
+  localtime_r(&seconds, &tm);
+  return fmt::format(
+      "{}/{}-{}_{:04d}{:02d}{:02d}_{:02d}{:02d}{:02d}_{:03d}_{}_{}",
+      dir,
+      device.driver,
+      device.serial,
+      tm.tm_year + 1900,
+      tm.tm_mon + 1,
+      tm.tm_mday,
+      tm.tm_hour,
+      tm.tm_min,
+      tm.tm_sec,
+      static_cast<int>(time.count() % 1000),
+      recording.recordingFrequency,
+      recording.bandwidth);
+}
+
+void removeOldRecordings(const std::string& dir, uint64_t maxTotalSize) {
+  std::unique_lock lock(retentionMutex);
+  std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+  uint64_t totalSize = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+    if (entry.is_regular_file() && entry.path().extension() == DATA_EXTENSION) {
+      files.emplace_back(entry.last_write_time(), entry.path());
+      totalSize += entry.file_size();
+    }
+  }
+  std::sort(files.begin(), files.end());
+  for (auto it = files.begin(); it != files.end() && maxTotalSize < totalSize; ++it) {
+    auto meta = it->second;
+    meta.replace_extension(META_EXTENSION);
+    totalSize -= std::filesystem::file_size(it->second);
+    Logger::info(LABEL, "retention limit reached, removing: {}", it->second.string());
+    std::filesystem::remove(it->second);
+    std::filesystem::remove(meta);
+  }
+}
+}  // namespace
+
+SigmfSink::SigmfSink(const std::string& dir, const Device& device, const Recording& recording, const std::string& format, uint64_t maxFileSize, uint64_t maxTotalSize)
+    : gr::sync_block("SigmfSink", gr::io_signature::make(1, 1, format == "ci8" ? 2 * sizeof(int8_t) : 2 * sizeof(int16_t)), gr::io_signature::make(0, 0, 0)),
+      m_dir(dir),
+      m_device(device),
+      m_recording(recording),
+      m_format(format),
+      m_itemSize(format == "ci8" ? 2 * sizeof(int8_t) : 2 * sizeof(int16_t)),
+      m_maxFileSize(maxFileSize),
+      m_maxTotalSize(maxTotalSize),
+      m_sampleTime(recording.bandwidth),
+      m_buffer(WRITE_BUFFER_SIZE),
+      m_file(nullptr),
+      m_fileStartTime(0),
+      m_fileItems(0),
+      m_isCommitted(false),
+      m_isRunning(true),
+      m_thread([this]() {
+        setThreadName("sigmf");
+        std::unique_lock lock(m_mutex);
+        while (m_isRunning || !m_closed.empty()) {
+          m_cv.wait(lock, [this]() { return !m_isRunning || !m_closed.empty(); });
+          while (!m_closed.empty()) {
+            auto closed = std::move(m_closed.front());
+            m_closed.pop_front();
+            lock.unlock();
+            finalize(closed);
+            lock.lock();
+          }
+        }
+      }) {
+  std::filesystem::create_directories(m_dir);
+}
+
+SigmfSink::~SigmfSink() {
+  closeFile();
+  m_isRunning = false;
+  m_cv.notify_all();
+  m_thread.join();
+}
+
+int SigmfSink::work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star&) {
+  std::vector<gr::tag_t> tags;
+  get_tags_in_window(tags, 0, 0, noutput_items, rxTimeTag());
+  m_sampleTime.update(tags, nitems_read(0));
+
+  const auto bytes = static_cast<uint64_t>(noutput_items) * m_itemSize;
+  if (m_file && 0 < m_fileItems && m_maxFileSize < m_fileItems * m_itemSize + bytes) {
+    closeFile();
+  }
+  if (!m_file) {
+    m_fileStartTime = m_sampleTime.get(nitems_read(0));
+    openFile();
+  }
+  if (m_file) {
+    const auto written = std::fwrite(input_items[0], m_itemSize, noutput_items, m_file);
+    m_fileItems += written;
+    if (written != static_cast<size_t>(noutput_items)) {
+      // disk full or io error, keep what was written and start next file on next call
+      Logger::warn(LABEL, "short write: {}, written: {}, expected: {}", m_path + DATA_EXTENSION, colored(RED, "{}", written), noutput_items);
+      closeFile();
+    }
+  }
+  return noutput_items;
+}
+
+bool SigmfSink::stop() {
+  closeFile();
+  return true;
+}
+
+void SigmfSink::commit() { m_isCommitted = true; }
+
+void SigmfSink::openFile() {
+  m_path = getBaseName(m_dir, m_device, m_recording, m_fileStartTime);
+  m_file = std::fopen((m_path + DATA_EXTENSION).c_str(), "wb");
+  if (!m_file) {
+    Logger::warn(LABEL, "open file failed: {}", m_path + DATA_EXTENSION);
+    return;
+  }
+  // previous buffer is owned by closed file until worker closes it
+  m_buffer.resize(WRITE_BUFFER_SIZE);
+  std::setvbuf(m_file, m_buffer.data(), _IOFBF, m_buffer.size());
+  m_fileItems = 0;
+}
+
+void SigmfSink::closeFile() {
+  if (!m_file) {
+    return;
+  }
+  std::unique_lock lock(m_mutex);
+  m_closed.push_back({m_file, std::move(m_buffer), m_path, m_fileStartTime, m_fileItems, m_isCommitted});
+  lock.unlock();
+  m_cv.notify_one();
+  m_buffer.clear();
+  m_file = nullptr;
+}
+
+void SigmfSink::finalize(ClosedFile& closed) const {
+  // flushes buffered data, may block on slow disk
+  if (std::fclose(closed.file) != 0) {
+    Logger::warn(LABEL, "close file failed: {}", closed.path + DATA_EXTENSION);
+  }
+  closed.buffer.clear();
+
+  if (!closed.isCommitted) {
+    std::filesystem::remove(closed.path + DATA_EXTENSION);
+    return;
+  }
+
+  const auto endTime = closed.startTime + std::chrono::milliseconds(closed.items * 1000 / m_recording.bandwidth);
+  nlohmann::json meta;
+  meta["global"]["core:datatype"] = m_format == "ci8" ? "ci8" : "ci16_le";
+  meta["global"]["core:sample_rate"] = m_recording.bandwidth;
+  meta["global"]["core:version"] = "1.0.0";
+  meta["global"]["core:hw"] = fmt::format("{} {}", m_device.driver, m_device.serial);
+  meta["global"]["core:recorder"] = "sdr-scanner";
+  meta["global"]["core:description"] = fmt::format("source: {}, name: {}, modulation: {}", m_recording.source, m_recording.name, m_recording.modulation);
+  meta["captures"] = nlohmann::json::array({{{"core:sample_start", 0}, {"core:frequency", m_recording.recordingFrequency}, {"core:datetime", formatDateTime(closed.startTime)}}});
+  meta["annotations"] = nlohmann::json::array({{
+      {"core:sample_start", 0},
+      {"core:sample_count", closed.items},
+      {"core:freq_lower_edge", m_recording.recordingFrequency - m_recording.bandwidth / 2},
+      {"core:freq_upper_edge", m_recording.recordingFrequency + m_recording.bandwidth / 2},
+      {"core:label", m_recording.name},
+      {"core:comment", fmt::format("end: {}", formatDateTime(endTime))},
+  }});
+  std::ofstream stream(closed.path + META_EXTENSION);
+  if (stream) {
+    stream << std::setw(4) << meta << std::endl;
+  }
+  Logger::info(LABEL, "saved: {}, samples: {}", colored(GREEN, "{}", closed.path), closed.items);
+
+  try {
+    removeOldRecordings(m_dir, m_maxTotalSize);
+  } catch (const std::exception& exception) {
+    Logger::exception(LABEL, exception, SPDLOG_LOC, "remove old recordings failed");
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <gnuradio/sync_block.h>
+#include <radio/blocks/sample_time.h>
+#include <radio/help_structures.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// closing files, writing meta and retention cleanup run on own worker thread, work only does buffered writes
+class SigmfSink : virtual public gr::sync_block {
+ public:
+  SigmfSink(const std::string& dir, const Device& device, const Recording& recording, const std::string& format, uint64_t maxFileSize, uint64_t maxTotalSize);
+  ~SigmfSink();
+
+  int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) override;
+  bool stop() override;
+
+  void commit();
+
+ private:
+  struct ClosedFile {
+    std::FILE* file;
+    std::vector<char> buffer;
+    std::string path;
+    std::chrono::milliseconds startTime;
+    uint64_t items;
+    bool isCommitted;
+  };
+
+  void openFile();
+  void closeFile();
+  void finalize(ClosedFile& closed) const;
+
+  const std::string m_dir;
+  const Device m_device;
+  const Recording m_recording;
+  const std::string m_format;
+  const int m_itemSize;
+  const uint64_t m_maxFileSize;
+  const uint64_t m_maxTotalSize;
+  SampleTime m_sampleTime;
+  std::vector<char> m_buffer;
+  std::FILE* m_file;
+  std::string m_path;
+  std::chrono::milliseconds m_fileStartTime;
+  uint64_t m_fileItems;
+  std::atomic<bool> m_isCommitted;
+  std::atomic<bool> m_isRunning;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<ClosedFile> m_closed;
+  std::thread m_thread;
+};
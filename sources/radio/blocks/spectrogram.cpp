@@ -6,16 +6,20 @@
 
 constexpr auto LABEL = "spectogram";
 
-Spectrogram::Container::Container(int size) : m_counter(0), m_lastDataSendTime(getTime()) { m_sum.resize(size); }
+Spectrogram::Container::Container(int size, const std::chrono::milliseconds& time) : m_counter(0), m_lastDataSendTime(time) { m_sum.resize(size); }
 
-Spectrogram::Spectrogram(const int itemSize, const Frequency sampleRate, std::function<Frequency()> getFrequency, SendFunction send)
+Spectrogram::Spectrogram(const Device& device, const FrequencyRange& frequencyRange, const int itemSize, const Frequency sampleRate, const double itemRate, std::function<Frequency()> getFrequency, std::function<bool()> isEnabled, SendFunction send)
     : gr::sync_block("Spectrogram", gr::io_signature::make(1, 1, sizeof(float) * itemSize), gr::io_signature::make(0, 0, 0)),
       m_inputSize(itemSize),
       m_outputSize(std::min(SPECTROGRAM_MAX_FFT, getFft(sampleRate, SPECTROGRAM_PREFERRED_MAX_STEP))),
       m_decimatorFactor(m_inputSize / m_outputSize),
       m_sampleRate(sampleRate),
       m_getFrequency(getFrequency),
-      m_send(send) {
+      m_isEnabled(isEnabled),
+      m_send(send),
+      m_sampleTime(itemRate),
+      m_metrics("Spectrogram", device, frequencyRange),
+      m_isActive(false) {
   const auto step = m_sampleRate / m_outputSize;
   Logger::info(
       LABEL,
@@ -28,15 +32,34 @@ Spectrogram::Spectrogram(const int itemSize, const Frequency sampleRate, std::fu
 
 int Spectrogram::work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star&) {
   const float* in = static_cast<const float*>(input_items[0]);
+  const auto timer = m_metrics.work(*this, noutput_items);
+
+  if (!m_isEnabled()) {
+    if (m_isActive) {
+      Logger::debug(LABEL, "disabled, no subscribers");
+      m_containers.clear();
+      m_isActive = false;
+    }
+    return noutput_items;
+  }
+  if (!m_isActive) {
+    Logger::debug(LABEL, "enabled");
+    m_isActive = true;
+  }
+
+  std::vector<gr::tag_t> tags;
+  get_tags_in_window(tags, 0, 0, noutput_items, rxTimeTag());
+  m_sampleTime.update(tags, nitems_read(0));
 
   for (int i = 0; i < noutput_items; ++i) {
+    const auto time = m_sampleTime.get(nitems_read(0) + i);
     const auto frequency = m_getFrequency();
     auto it = m_containers.find(frequency);
     if (it == m_containers.end()) {
-      it = m_containers.emplace(frequency, m_outputSize).first;
+      it = m_containers.emplace(std::piecewise_construct, std::forward_as_tuple(frequency), std::forward_as_tuple(m_outputSize, time)).first;
     }
     process(it->second, &in[i * m_inputSize]);
-    send(it->second);
+    send(it->second, time);
   }
 
   return noutput_items;
@@ -59,17 +82,16 @@ void Spectrogram::process(Container& container, const float* data) {
   container.m_counter++;
 }
 
-void Spectrogram::send(Container& container) {
-  const auto now = getTime();
+void Spectrogram::send(Container& container, const std::chrono::milliseconds& time) {
   const auto frequency = m_getFrequency();
-  if (container.m_lastDataSendTime + SPECTROGRAM_SEND_INTERVAL < now) {
+  if (container.m_lastDataSendTime + SPECTROGRAM_SEND_INTERVAL < time) {
     std::vector<int8_t> tmp(m_outputSize);
     for (int j = 0; j < m_outputSize; ++j) {
       tmp[j] = container.m_sum[j] / container.m_counter;
     }
-    m_send(now, frequency, tmp);
+    m_send(time, frequency, tmp);
     std::memset(container.m_sum.data(), 0, sizeof(float) * container.m_sum.size());
     container.m_counter = 0;
-    container.m_lastDataSendTime = now;
+    container.m_lastDataSendTime = time;
   }
 }
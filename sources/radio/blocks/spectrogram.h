@@ -1,6 +1,8 @@
 #pragma once
 
 #include <gnuradio/sync_block.h>
+#include <radio/blocks/block_metrics.h>
+#include <radio/blocks/sample_time.h>
 #include <radio/help_structures.h>
 
 #include <functional>
@@ -8,7 +10,7 @@
 
 class Spectrogram : virtual public gr::sync_block {
   struct Container {
-    Container(int size);
+    Container(int size, const std::chrono::milliseconds& time);
 
     std::vector<float> m_sum;
     int m_counter;
@@ -18,19 +20,23 @@ class Spectrogram : virtual public gr::sync_block {
   using SendFunction = std::function<void(const std::chrono::milliseconds&, const Frequency&, const std::vector<int8_t>&)>;
 
  public:
-  Spectrogram(const int itemSize, const Frequency sampleRate, std::function<Frequency()> getFrequency, SendFunction send);
+  Spectrogram(const Device& device, const FrequencyRange& frequencyRange, const int itemSize, const Frequency sampleRate, const double itemRate, std::function<Frequency()> getFrequency, std::function<bool()> isEnabled, SendFunction send);
 
   int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) override;
 
  private:
   void process(Container& container, const float* data);
-  void send(Container& container);
+  void send(Container& container, const std::chrono::milliseconds& time);
 
   const int m_inputSize;
   const int m_outputSize;
   const int m_decimatorFactor;
   const Frequency m_sampleRate;
   const std::function<Frequency()> m_getFrequency;
+  const std::function<bool()> m_isEnabled;
   const SendFunction m_send;
+  SampleTime m_sampleTime;
+  BlockMetrics m_metrics;
   std::map<Frequency, Container> m_containers;
+  bool m_isActive;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <config.h>
 #include <logger.h>
+#include <tracer.h>
 #include <utils/utils.h>
 
 constexpr auto LABEL = "transmission";
@@ -9,62 +10,99 @@ constexpr auto LABEL = "transmission";
 Transmission::Transmission(
     const Config& config,
     const Device& device,
+    const FrequencyRange& frequencyRange,
     const int itemSize,
     const int groupSize,
+    const double itemRate,
     TransmissionNotification& notification,
     std::function<Frequency()> getFrequency,
     std::function<Frequency(const Index index)> indexToFrequency,
     std::function<Frequency(const Index index)> indexToShift,
     std::function<bool(const int Index)> isIndexInRange)
     : gr::sync_block("Transmission", gr::io_signature::make(1, 1, sizeof(float) * itemSize), gr::io_signature::make(0, 0, 0)),
-      m_config(config),
       m_device(device),
+      m_detection(config, device),
       m_itemSize(itemSize),
       m_groupSize(groupSize),
-      m_averager(itemSize, GROUPING_Y),
+      m_averager(itemSize, GROUPING_Y, Averager::parsePrecision(config.historyPrecision())),
+      m_sampleTime(itemRate),
       m_notification(notification),
       m_getFrequency(getFrequency),
       m_indexToFrequency(indexToFrequency),
       m_indexToShift(indexToShift),
-      m_isIndexInRange(isIndexInRange) {
+      m_isIndexInRange(isIndexInRange),
+      m_metrics("Transmission", device, frequencyRange),
+      m_detectionLatency("DetectionLatency", device, frequencyRange),
+      m_detections(Metrics::counter("sdr_detections_total", "detected transmissions", {{"device", device.getName()}})) {
   Logger::info(LABEL, "group size: {}", colored(GREEN, "{}", m_groupSize));
 }
 
 int Transmission::work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star&) {
   const float* input_buf = static_cast<const float*>(input_items[0]);
+  const auto timer = m_metrics.work(*this, noutput_items);
+
+  std::vector<gr::tag_t> tags;
+  get_tags_in_window(tags, 0, 0, noutput_items, rxTimeTag());
+  m_sampleTime.update(tags, nitems_read(0));
+
+  std::vector<gr::tag_t> discontinuities;
+  get_tags_in_window(discontinuities, 0, 0, noutput_items, discontinuityTag());
+  auto discontinuity = discontinuities.begin();
 
   std::unique_lock<std::mutex> lock(m_mutex);
+  m_detection.refresh();
   for (int i = 0; i < noutput_items; ++i) {
-    process(&input_buf[i * m_itemSize]);
+    const auto offset = nitems_read(0) + i;
+    if (discontinuity != discontinuities.end() && discontinuity->offset <= offset) {
+      reset(m_sampleTime.get(offset));
+      while (discontinuity != discontinuities.end() && discontinuity->offset <= offset) {
+        discontinuity++;
+      }
+    }
+    process(&input_buf[i * m_itemSize], m_sampleTime.get(offset));
   }
+  // end to end latency from sample reception to detection, includes buffering
+  const auto latency = getTime() - m_sampleTime.get(nitems_read(0) + noutput_items - 1);
+  m_detectionLatency.record(std::max(std::chrono::nanoseconds(0), std::chrono::duration_cast<std::chrono::nanoseconds>(latency)));
 
   return noutput_items;
 }
 
-void Transmission::process(const float* power) {
+void Transmission::process(const float* power, const std::chrono::milliseconds now) {
   m_averager.push(power);
-  const auto bufferPower = m_averager.average();
+  const auto& bufferPower = m_averager.average();
   std::vector<float> avgPower(bufferPower.size(), 0.0);
   average(bufferPower.data(), avgPower.data(), bufferPower.size(), GROUPING_X);
 
-  const auto now = getTime();
   addSignals(avgPower.data(), power, now);
   updateSignals(avgPower.data(), power, now);
   clearSignals(avgPower.data(), power, now);
   m_notification.notify(getSortedTransmissions(now));
 }
 
+void Transmission::reset(const std::chrono::milliseconds now) {
+  for (const auto& [index, signal] : m_signals) {
+    Logger::info(LABEL, "signal: {}, stop: samples lost", formatFrequency(m_indexToFrequency(index), BROWN));
+    Tracer::asyncEnd("signal", m_indexToFrequency(index));
+  }
+  m_signals.clear();
+  m_averager.reset();
+  m_notification.notify(getSortedTransmissions(now));
+}
+
 void Transmission::clearSignals(const float*, const float*, const std::chrono::milliseconds now) {
+  const auto& detection = m_detection.get();
   for (auto it = m_signals.begin(); it != m_signals.cend();) {
     const auto& [index, signal] = *it;
-    if (signal.isTimeout(now) || signal.isMaximalTime(now)) {
-      const auto bestTunedFrequency = getTunedFrequency(m_indexToFrequency(index), m_config.recordingTuningStep());
+    if (signal.isTimeout(detection, now) || signal.isMaximalTime(now)) {
+      const auto bestTunedFrequency = getTunedFrequency(m_indexToFrequency(index), detection.tuningStep);
       Logger::info(
           LABEL,
           "signal: {}, stop: {}, center: {}",
           formatFrequency(m_indexToFrequency(index), BROWN),
           formatFrequency(bestTunedFrequency, CYAN),
           formatFrequency(m_indexToFrequency(signal.getIndex()), MAGENTA));
+      Tracer::asyncEnd("signal", m_indexToFrequency(index));
       m_signals.erase(it++);
     } else {
       it++;
@@ -73,9 +111,10 @@ void Transmission::clearSignals(const float*, const float*, const std::chrono::m
 }
 
 void Transmission::addSignals(const float* avgPower, const float* rawPower, const std::chrono::milliseconds now) {
+  const auto& detection = m_detection.get();
   std::vector<Index> indexes;
   for (int i = 0; i < m_itemSize; ++i) {
-    if (m_device.start_recording_level <= avgPower[i] && m_isIndexInRange(i) && !isIndexIgnored(i)) {
+    if (detection.startLevel <= avgPower[i] && m_isIndexInRange(i) && !isIndexIgnored(detection, i)) {
       indexes.push_back(i);
     }
   }
@@ -84,7 +123,7 @@ void Transmission::addSignals(const float* avgPower, const float* rawPower, cons
   for (const auto& index : indexes) {
     if (!containsWithMargin(m_signals, index, m_groupSize)) {
       const auto bestIndex = getBestIndex(index);
-      const auto bestTunedFrequency = getTunedFrequency(m_indexToFrequency(bestIndex), m_config.recordingTuningStep());
+      const auto bestTunedFrequency = getTunedFrequency(m_indexToFrequency(bestIndex), detection.tuningStep);
       Logger::info(
           LABEL,
           "signal: {}, start: {}, avg power: {}, raw power: {}",
@@ -92,38 +131,44 @@ void Transmission::addSignals(const float* avgPower, const float* rawPower, cons
           formatFrequency(bestTunedFrequency, CYAN),
           formatPower(avgPower[bestIndex], BROWN),
           formatPower(rawPower[bestIndex], BROWN));
-      m_signals.insert({bestIndex, {m_config, m_device, m_indexToFrequency, m_indexToShift, now}});
+      m_signals.insert({bestIndex, {m_indexToFrequency, m_indexToShift, now}});
+      m_detections.inc();
+      Tracer::asyncBegin("signal", m_indexToFrequency(bestIndex));
     }
   }
 }
 
 void Transmission::updateSignals(const float* avgPower, const float* rawPower, const std::chrono::milliseconds now) {
+  const auto& detection = m_detection.get();
   for (auto& [index, signal] : m_signals) {
     const auto bestAvgIndex = getMaxIndex(avgPower, m_itemSize, index, m_groupSize);
     const auto bestRawIndex = getMaxIndex(rawPower, m_itemSize, index, m_groupSize);
-    signal.newData(bestAvgIndex, avgPower[bestAvgIndex], bestRawIndex, rawPower[bestRawIndex], now);
-    Logger::debug(
-        LABEL,
-        "signal: {}, best avg: {}, {}, best raw: {}, {}, d: {:5d} ms, ld: {:5d} ms ago, fl: {}",
-        formatFrequency(m_indexToFrequency(index), BROWN),
-        formatFrequency(m_indexToFrequency(bestAvgIndex), CYAN),
-        formatPower(avgPower[bestAvgIndex], CYAN),
-        formatFrequency(m_indexToFrequency(bestRawIndex), MAGENTA),
-        formatPower(rawPower[bestRawIndex], MAGENTA),
-        signal.getDuration().count(),
-        signal.getLastDataTime(now).count(),
-        signal.needFlush(now) ? 1 : 0);
+    signal.newData(detection, bestAvgIndex, avgPower[bestAvgIndex], bestRawIndex, rawPower[bestRawIndex], now);
+    if (Logger::isEnabled(spdlog::level::debug)) {
+      Logger::debug(
+          LABEL,
+          "signal: {}, best avg: {}, {}, best raw: {}, {}, d: {:5d} ms, ld: {:5d} ms ago, fl: {}",
+          formatFrequency(m_indexToFrequency(index), BROWN),
+          formatFrequency(m_indexToFrequency(bestAvgIndex), CYAN),
+          formatPower(avgPower[bestAvgIndex], CYAN),
+          formatFrequency(m_indexToFrequency(bestRawIndex), MAGENTA),
+          formatPower(rawPower[bestRawIndex], MAGENTA),
+          signal.getDuration().count(),
+          signal.getLastDataTime(now).count(),
+          signal.needFlush(detection, now) ? 1 : 0);
+    }
   }
 }
 
 Transmission::Index Transmission::getBestIndex(Index index) const {
   std::vector<Transmission::Index> buffer;
-  const auto min = m_averager.data().size() / 2;
-  const auto max = m_averager.data().size();
-  for (size_t i = min; i < max; ++i) {
-    const auto& row = m_averager.data().at(i);
-    const auto bestIndex = getMaxIndex(row.data(), row.size(), index, m_groupSize);
-    if (m_device.start_recording_level <= row[bestIndex]) {
+  const auto min = m_averager.frames() / 2;
+  const auto max = m_averager.frames();
+  const auto startLevel = m_detection.get().startLevel;
+  for (int i = min; i < max; ++i) {
+    const auto bestIndex = m_averager.getMaxIndex(i, index, m_groupSize);
+    const auto power = m_averager.get(i, bestIndex);
+    if (startLevel <= power) {
       const int timestamp = max - i - 1;
       Logger::debug(
           LABEL,
@@ -131,7 +176,7 @@ Transmission::Index Transmission::getBestIndex(Index index) const {
           formatFrequency(m_indexToFrequency(index), BROWN),
           -timestamp,
           formatFrequency(m_indexToFrequency(bestIndex), MAGENTA),
-          formatPower(row[bestIndex], MAGENTA));
+          formatPower(power, MAGENTA));
       buffer.push_back(bestIndex);
     }
   }
@@ -140,9 +185,9 @@ Transmission::Index Transmission::getBestIndex(Index index) const {
   return mostFrequentIndex;
 }
 
-bool Transmission::isIndexIgnored(const Index& index) const {
+bool Transmission::isIndexIgnored(const DetectionConfig& detection, const Index& index) const {
   const auto frequency = m_indexToFrequency(index);
-  for (const auto& range : m_config.ignoredRanges()) {
+  for (const auto& range : detection.ignoredRanges) {
     if (range.contains(frequency)) {
       return true;
     }
@@ -151,16 +196,17 @@ bool Transmission::isIndexIgnored(const Index& index) const {
 }
 
 std::vector<Recording> Transmission::getSortedTransmissions(const std::chrono::milliseconds now) const {
+  const auto& detection = m_detection.get();
   std::vector<Index> indexes;
   std::transform(m_signals.begin(), m_signals.end(), std::back_inserter(indexes), [](auto& kv) { return kv.first; });
   std::sort(indexes.begin(), indexes.end(), [this](const Index& i1, const Index& i2) { return m_signals.at(i1).getPower() > m_signals.at(i2).getPower(); });
   std::vector<Recording> transmissions;
   for (const auto& index : indexes) {
     const auto deviceFrequency = m_getFrequency();
-    const auto shiftFrequency = getTunedFrequency(m_indexToShift(index), m_config.recordingTuningStep());
+    const auto shiftFrequency = getTunedFrequency(m_indexToShift(index), detection.tuningStep);
     const auto source = m_device.alias.empty() ? SCANNER_SOURCE_NAME : GAIN_TESTER_SOURCE_NAME;
     const auto name = m_device.alias.empty() ? SCANNER_RECORDING_NAME : GAIN_TESTER_RECORDING_NAME;
-    transmissions.emplace_back(source, name, deviceFrequency, deviceFrequency + shiftFrequency, m_config.recordingBandwidth(), "", m_signals.at(index).needFlush(now));
+    transmissions.emplace_back(source, name, deviceFrequency, deviceFrequency + shiftFrequency, detection.bandwidth, "", m_signals.at(index).needFlush(detection, now));
   }
   return transmissions;
 }
@@ -3,6 +3,8 @@
 #include <config.h>
 #include <gnuradio/sync_block.h>
 #include <radio/averager.h>
+#include <radio/blocks/block_metrics.h>
+#include <radio/blocks/sample_time.h>
 #include <radio/help_structures.h>
 #include <radio/signal.h>
 
@@ -17,8 +19,10 @@ class Transmission : virtual public gr::sync_block {
   Transmission(
       const Config& config,
       const Device& device,
+      const FrequencyRange& frequencyRange,
       const int itemSize,
       const int groupSize,
+      const double itemRate,
       TransmissionNotification& notification,
       std::function<Frequency()> getFrequency,
       std::function<Frequency(const int index)> indexToFrequency,
@@ -28,19 +32,22 @@ class Transmission : virtual public gr::sync_block {
   int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items) override;
 
  private:
-  void process(const float* power);
+  void process(const float* power, const std::chrono::milliseconds now);
+  // samples were lost, open signals and averaged history do not continue after gap
+  void reset(const std::chrono::milliseconds now);
   void clearSignals(const float* avgPower, const float* rawPower, const std::chrono::milliseconds now);
   void addSignals(const float* avgPower, const float* rawPower, const std::chrono::milliseconds now);
   void updateSignals(const float* avgPower, const float* rawPower, const std::chrono::milliseconds now);
   Index getBestIndex(Index index) const;
-  bool isIndexIgnored(const Index& index) const;
+  bool isIndexIgnored(const DetectionConfig& detection, const Index& index) const;
   std::vector<Recording> getSortedTransmissions(const std::chrono::milliseconds now) const;
 
-  const Config& m_config;
   const Device& m_device;
+  DetectionSnapshot m_detection;
   const int m_itemSize;
   const int m_groupSize;
   Averager m_averager;
+  SampleTime m_sampleTime;
   TransmissionNotification& m_notification;
   const std::function<Frequency()> m_getFrequency;
   const std::function<Frequency(const Index index)> m_indexToFrequency;
@@ -48,4 +55,7 @@ class Transmission : virtual public gr::sync_block {
   const std::function<bool(const Index index)> m_isIndexInRange;
   std::mutex m_mutex;
   std::map<Index, Signal> m_signals;
+  BlockMetrics m_metrics;
+  BlockMetrics m_detectionLatency;
+  Counter& m_detections;
 };
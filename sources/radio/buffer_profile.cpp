@@ -0,0 +1,66 @@
+#include "buffer_profile.h"
+
+#include <config.h>
+
+constexpr auto LATENCY_FRAMES = 2;             // buffered detection frames in latency profile
+constexpr auto THROUGHPUT_FRAMES = 8;          // detection frames per work call in throughput profile
+constexpr auto THROUGHPUT_STREAM_FRAMES = 2;   // raw sample frames per work call in throughput profile
+constexpr auto DEFAULT_FFT_BATCH = 4;          // detection frames transformed together in default profile
+constexpr auto LATENCY_RECORDER_BUFFER = 100;  // recorder work call covers 1 / n second in latency profile
+constexpr auto LATENCY_OUTPUT_MULTIPLE = 1024;
+constexpr auto DEFAULT_OUTPUT_MULTIPLE = 4096;
+
+BufferProfile::BufferProfile(const std::string& name, Frequency sampleRate)
+    : m_type(name == "latency" ? Type::Latency : name == "throughput" ? Type::Throughput : Type::Default), m_frameSize(std::max(1, static_cast<int>(sampleRate / SIGNAL_DETECTION_FPS))) {}
+
+void BufferProfile::source(const Block& block) const {
+  if (m_type == Type::Latency) {
+    block->set_min_output_buffer(LATENCY_FRAMES * m_frameSize);
+  } else if (m_type == Type::Throughput) {
+    block->set_min_output_buffer(2 * THROUGHPUT_STREAM_FRAMES * m_frameSize);
+  }
+}
+
+void BufferProfile::stream(const Block& block) const {
+  if (m_type == Type::Latency) {
+    block->set_max_noutput_items(m_frameSize);
+    block->set_min_output_buffer(LATENCY_FRAMES * m_frameSize);
+  } else if (m_type == Type::Throughput) {
+    block->set_max_noutput_items(THROUGHPUT_STREAM_FRAMES * m_frameSize);
+    block->set_min_output_buffer(2 * THROUGHPUT_STREAM_FRAMES * m_frameSize);
+  }
+}
+
+void BufferProfile::frames(const Block& block) const {
+  if (m_type == Type::Latency) {
+    block->set_max_noutput_items(1);
+    block->set_min_output_buffer(LATENCY_FRAMES);
+  } else if (m_type == Type::Throughput) {
+    block->set_max_noutput_items(THROUGHPUT_FRAMES);
+    block->set_min_output_buffer(2 * THROUGHPUT_FRAMES);
+  }
+}
+
+int BufferProfile::fftBatch() const { return m_type == Type::Latency ? 1 : m_type == Type::Throughput ? THROUGHPUT_FRAMES : DEFAULT_FFT_BATCH; }
+
+void BufferProfile::recorder(const Block& block, Frequency sampleRate) const {
+  if (m_type == Type::Latency) {
+    const auto items = std::max(LATENCY_OUTPUT_MULTIPLE, static_cast<int>(sampleRate / LATENCY_RECORDER_BUFFER));
+    block->set_max_noutput_items(items);
+    block->set_min_output_buffer(2 * items);
+  }
+}
+
+int BufferProfile::recorderOutputMultiple() const { return m_type == Type::Latency ? LATENCY_OUTPUT_MULTIPLE : DEFAULT_OUTPUT_MULTIPLE; }
+
+std::string BufferProfile::name() const { return m_type == Type::Latency ? "latency" : m_type == Type::Throughput ? "throughput" : "default"; }
+
+std::chrono::milliseconds BufferProfile::bufferingLatency() const {
+  const auto frameTime = std::chrono::milliseconds(1000 / SIGNAL_DETECTION_FPS);
+  if (m_type == Type::Latency) {
+    return 2 * LATENCY_FRAMES * frameTime;
+  } else if (m_type == Type::Throughput) {
+    return 2 * (THROUGHPUT_STREAM_FRAMES + THROUGHPUT_FRAMES) * frameTime;
+  }
+  return std::chrono::milliseconds(0);
+}
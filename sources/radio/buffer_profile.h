@@ -0,0 +1,38 @@
+#pragma once
+
+#include <radio/connection.h>
+#include <radio/help_structures.h>
+
+#include <chrono>
+#include <string>
+
+// sizes gnuradio buffers of device, detection and recorder graphs
+// latency passes every detection frame downstream as soon as it is ready
+// throughput batches frames to reduce scheduler overhead
+// default keeps gnuradio defaults
+class BufferProfile {
+ public:
+  BufferProfile(const std::string& name, Frequency sampleRate);
+
+  // source output, read size is limited by device mtu
+  void source(const Block& block) const;
+  // raw samples consumed by detection, one frame is fft size * decimator factor
+  void stream(const Block& block) const;
+  // detection vectors, one item per frame
+  void frames(const Block& block) const;
+  // detection frames transformed by single fft plan, matches frames per work call
+  int fftBatch() const;
+  // recorder sample stream blocks, sample rate of block output
+  void recorder(const Block& block, Frequency sampleRate) const;
+  int recorderOutputMultiple() const;
+
+  std::string name() const;
+  // worst case time of detection frame waiting in buffers, zero if unknown
+  std::chrono::milliseconds bufferingLatency() const;
+
+ private:
+  enum class Type { Default, Latency, Throughput };
+
+  const Type m_type;
+  const int m_frameSize;
+};
@@ -28,6 +28,18 @@ class Connector {
 
   void connect(Block block1, Block block2, const int index1 = 0, const int index2 = 0) { m_connections.emplace_back(m_tb, block1, block2, index1, index2); }
 
+  // pins threads of all connected blocks, applied when flowgraph starts
+  void setProcessorAffinity(const std::vector<int>& cores) {
+    if (!cores.empty()) {
+      for (const auto& block : getBlocks()) {
+        block->set_processor_affinity(cores);
+      }
+    }
+  }
+
+  // disconnects all blocks, top block must be locked when running
+  void clear() { m_connections.clear(); }
+
   std::vector<Block> getBlocks() {
     std::vector<Block> blocks;
     auto add = [&blocks](const Block block) {
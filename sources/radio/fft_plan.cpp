@@ -0,0 +1,140 @@
+#include "fft_plan.h"
+
+#include <logger.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+constexpr auto LABEL = "fft";
+
+namespace {
+
+// fftw planner is not thread safe, processors of all devices are created in parallel
+std::mutex plannerMutex;
+bool isThreadsInitialized = false;
+bool isWisdomLoaded = false;
+
+// requires plannerMutex
+fftwf_plan createPlan(int fftSize, int frames, int threads, std::complex<float>* input, std::complex<float>* output, unsigned flags) {
+  if (!isThreadsInitialized) {
+    fftwf_init_threads();
+    isThreadsInitialized = true;
+  }
+  fftwf_plan_with_nthreads(threads);
+  return fftwf_plan_many_dft(
+      1, &fftSize, frames, reinterpret_cast<fftwf_complex*>(input), nullptr, 1, fftSize, reinterpret_cast<fftwf_complex*>(output), nullptr, 1, fftSize, FFTW_FORWARD, flags);
+}
+
+}  // namespace
+
+void FftPlan::prepare(const std::string& wisdomFile, int fftSize, int batchSize, int threads) {
+  batchSize = std::max(1, batchSize);
+  threads = std::max(1, threads);
+  const auto input = allocate(fftSize * batchSize);
+  const auto output = allocate(fftSize * batchSize);
+
+  std::unique_lock<std::mutex> lock(plannerMutex);
+  if (!isWisdomLoaded) {
+    if (fftwf_import_wisdom_from_filename(wisdomFile.c_str())) {
+      Logger::info(LABEL, "wisdom loaded: {}", colored(GREEN, "{}", wisdomFile));
+    }
+    isWisdomLoaded = true;
+  }
+  bool isMeasured = false;
+  for (const auto frames : {1, batchSize}) {
+    auto plan = createPlan(fftSize, frames, threads, input.get(), output.get(), FFTW_MEASURE | FFTW_WISDOM_ONLY);
+    if (!plan) {
+      Logger::info(LABEL, "measuring plan, fft: {}, frames: {}, threads: {}", colored(GREEN, "{}", fftSize), colored(GREEN, "{}", frames), colored(GREEN, "{}", threads));
+      plan = createPlan(fftSize, frames, threads, input.get(), output.get(), FFTW_MEASURE);
+      if (!plan) {
+        throw std::runtime_error(fmt::format("fftw plan failed, fft: {}, frames: {}", fftSize, frames));
+      }
+      isMeasured = true;
+    }
+    fftwf_destroy_plan(plan);
+  }
+  if (isMeasured && !fftwf_export_wisdom_to_filename(wisdomFile.c_str())) {
+    Logger::warn(LABEL, "save wisdom failed: {}", colored(RED, "{}", wisdomFile));
+  }
+}
+
+FftPlan::FftPlan(int fftSize, const std::vector<float>& window, int batchSize, int threads)
+    : m_fftSize(fftSize),
+      m_batchSize(std::max(1, batchSize)),
+      m_window(window),
+      m_input(allocate(fftSize * m_batchSize)),
+      m_output(allocate(fftSize * m_batchSize)),
+      m_batchPlan(nullptr),
+      m_framePlan(nullptr) {
+  threads = std::max(1, threads);
+  const auto planFrames = [this, threads](int frames) {
+    auto plan = createPlan(m_fftSize, frames, threads, m_input.get(), m_output.get(), FFTW_MEASURE | FFTW_WISDOM_ONLY);
+    if (!plan) {
+      Logger::warn(LABEL, "plan missing in wisdom, using estimated plan, fft: {}, frames: {}", colored(RED, "{}", m_fftSize), colored(RED, "{}", frames));
+      plan = createPlan(m_fftSize, frames, threads, m_input.get(), m_output.get(), FFTW_ESTIMATE);
+    }
+    if (!plan) {
+      throw std::runtime_error(fmt::format("fftw plan failed, fft: {}, frames: {}", m_fftSize, frames));
+    }
+    return plan;
+  };
+
+  std::unique_lock<std::mutex> lock(plannerMutex);
+  m_framePlan = planFrames(1);
+  if (1 < m_batchSize) {
+    try {
+      m_batchPlan = planFrames(m_batchSize);
+    } catch (...) {
+      fftwf_destroy_plan(m_framePlan);
+      throw;
+    }
+  }
+}
+
+FftPlan::~FftPlan() {
+  std::unique_lock<std::mutex> lock(plannerMutex);
+  if (m_batchPlan) {
+    fftwf_destroy_plan(m_batchPlan);
+  }
+  fftwf_destroy_plan(m_framePlan);
+}
+
+void FftPlan::transform(const std::complex<float>* input, std::complex<float>* output, int frames) {
+  int i = 0;
+  if (m_batchPlan) {
+    for (; i + m_batchSize <= frames; i += m_batchSize) {
+      transformBatch(&input[i * m_fftSize], &output[i * m_fftSize], m_batchSize, m_batchPlan);
+    }
+  }
+  for (; i < frames; ++i) {
+    transformBatch(&input[i * m_fftSize], &output[i * m_fftSize], 1, m_framePlan);
+  }
+}
+
+FftPlan::Buffer FftPlan::allocate(int size) {
+  auto data = static_cast<std::complex<float>*>(fftwf_malloc(sizeof(std::complex<float>) * size));
+  if (!data) {
+    throw std::runtime_error(fmt::format("fftw malloc failed, size: {}", size));
+  }
+  return Buffer(data, fftwf_free);
+}
+
+void FftPlan::transformBatch(const std::complex<float>* input, std::complex<float>* output, int frames, const fftwf_plan& plan) {
+  auto* buffer = m_input.get();
+  for (int frame = 0; frame < frames; ++frame) {
+    const auto offset = frame * m_fftSize;
+    for (int j = 0; j < m_fftSize; ++j) {
+      buffer[offset + j] = input[offset + j] * m_window[j];
+    }
+  }
+  fftwf_execute(plan);
+  const auto* result = m_output.get();
+  const auto half = m_fftSize / 2;
+  for (int frame = 0; frame < frames; ++frame) {
+    const auto offset = frame * m_fftSize;
+    std::memcpy(&output[offset], &result[offset + half], sizeof(std::complex<float>) * (m_fftSize - half));
+    std::memcpy(&output[offset + m_fftSize - half], &result[offset], sizeof(std::complex<float>) * half);
+  }
+}
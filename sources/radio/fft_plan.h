@@ -0,0 +1,38 @@
+#pragma once
+
+#include <fftw3.h>
+
+#include <complex>
+#include <memory>
+#include <string>
+#include <vector>
+
+// windowed forward fft with output shift, frames are transformed in batches by single fftw plan, fftw threads split batch between cores
+// fftw planner is shared by all instances and serialized by global mutex
+class FftPlan {
+ public:
+  // measures plans missing in wisdom and saves wisdom when changed, may take seconds so call it before flowgraph lock
+  static void prepare(const std::string& wisdomFile, int fftSize, int batchSize, int threads);
+
+  // plans from wisdom only, falls back to estimated plan when prepare was not called for this size
+  FftPlan(int fftSize, const std::vector<float>& window, int batchSize, int threads);
+  ~FftPlan();
+  FftPlan(const FftPlan&) = delete;
+  FftPlan& operator=(const FftPlan&) = delete;
+
+  void transform(const std::complex<float>* input, std::complex<float>* output, int frames);
+
+ private:
+  using Buffer = std::unique_ptr<std::complex<float>, void (*)(void*)>;
+
+  static Buffer allocate(int size);
+  void transformBatch(const std::complex<float>* input, std::complex<float>* output, int frames, const fftwf_plan& plan);
+
+  const int m_fftSize;
+  const int m_batchSize;
+  const std::vector<float> m_window;
+  Buffer m_input;
+  Buffer m_output;
+  fftwf_plan m_batchPlan;
+  fftwf_plan m_framePlan;
+};
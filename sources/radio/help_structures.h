@@ -18,6 +18,7 @@ struct Recording {
   Frequency bandwidth;
   std::string modulation;
   bool flush;
+  Frequency doppler = 0;  // correction of recording frequency, updated during satellite pass
 
   Frequency shift() const { return recordingFrequency - deviceFrequency; }
 };
@@ -82,9 +83,12 @@ struct Device {
   std::vector<Satellite> satellites{};
   std::vector<Frequency> sample_rates{};
   std::vector<Crontab> crontabs;
+  std::vector<int> cores{};
+  bool pooled{};
+  bool iq_correction = true;
 
   std::string getName() const { return driver + "_" + serial; }
   std::string getAliasName() const { return alias.empty() ? getName() : alias; }
 };
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(
-    Device, connected, enabled, gains, serial, driver, alias, sample_rate, ranges, start_recording_level, stop_recording_level, satellites, sample_rates, crontabs)
+    Device, connected, enabled, gains, serial, driver, alias, sample_rate, ranges, start_recording_level, stop_recording_level, satellites, sample_rates, crontabs, cores, pooled, iq_correction)
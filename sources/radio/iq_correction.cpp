@@ -0,0 +1,66 @@
+#include "iq_correction.h"
+
+#include <cmath>
+
+constexpr auto MIN_POWER = 1e-12;  // skip iq correction of empty signal
+
+IqCorrection::IqCorrection(double timeConstant) : m_timeConstant(timeConstant), m_isInitialized(false), m_dcI(0.0), m_dcQ(0.0), m_powerI(0.0), m_powerQ(0.0), m_crossIQ(0.0) {}
+
+void IqCorrection::process(const std::complex<float>* input, std::complex<float>* output, int size) {
+  if (size <= 0) {
+    return;
+  }
+  const auto* in = reinterpret_cast<const float*>(input);
+  auto* out = reinterpret_cast<float*>(output);
+
+  float sumI = 0.0f;
+  float sumQ = 0.0f;
+  float sumII = 0.0f;
+  float sumQQ = 0.0f;
+  float sumIQ = 0.0f;
+  for (int i = 0; i < size; ++i) {
+    const auto valueI = in[2 * i];
+    const auto valueQ = in[2 * i + 1];
+    sumI += valueI;
+    sumQ += valueQ;
+    sumII += valueI * valueI;
+    sumQQ += valueQ * valueQ;
+    sumIQ += valueI * valueQ;
+  }
+  const auto meanI = static_cast<double>(sumI) / size;
+  const auto meanQ = static_cast<double>(sumQ) / size;
+  const auto powerI = sumII / size - meanI * meanI;
+  const auto powerQ = sumQQ / size - meanQ * meanQ;
+  const auto crossIQ = sumIQ / size - meanI * meanQ;
+
+  const auto weight = m_isInitialized ? 1.0 - std::exp(-size / m_timeConstant) : 1.0;
+  m_isInitialized = true;
+  m_dcI += weight * (meanI - m_dcI);
+  m_dcQ += weight * (meanQ - m_dcQ);
+  m_powerI += weight * (powerI - m_powerI);
+  m_powerQ += weight * (powerQ - m_powerQ);
+  m_crossIQ += weight * (crossIQ - m_crossIQ);
+
+  const auto dcI = static_cast<float>(m_dcI);
+  const auto dcQ = static_cast<float>(m_dcQ);
+  const auto phase = this->phase();
+  const auto gain = this->gain();
+  for (int i = 0; i < size; ++i) {
+    const auto valueI = in[2 * i] - dcI;
+    const auto valueQ = in[2 * i + 1] - dcQ;
+    out[2 * i] = valueI;
+    out[2 * i + 1] = (valueQ - phase * valueI) * gain;
+  }
+}
+
+std::complex<float> IqCorrection::dc() const { return {static_cast<float>(m_dcI), static_cast<float>(m_dcQ)}; }
+
+float IqCorrection::phase() const { return m_powerI < MIN_POWER ? 0.0f : static_cast<float>(m_crossIQ / m_powerI); }
+
+float IqCorrection::gain() const {
+  if (m_powerI < MIN_POWER) {
+    return 1.0f;
+  }
+  const auto powerQ = m_powerQ - m_crossIQ * m_crossIQ / m_powerI;
+  return powerQ < MIN_POWER ? 1.0f : static_cast<float>(std::sqrt(m_powerI / powerQ));
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <complex>
+
+// adaptive dc offset removal and blind iq imbalance correction
+// statistics are averaged per processed block with time constant in samples, loops work on interleaved floats to vectorize
+class IqCorrection {
+ public:
+  explicit IqCorrection(double timeConstant);
+
+  void process(const std::complex<float>* input, std::complex<float>* output, int size);
+
+  std::complex<float> dc() const;
+  // q correction, q' = (q - phase * i) * gain
+  float phase() const;
+  float gain() const;
+
+ private:
+  const double m_timeConstant;
+  bool m_isInitialized;
+  double m_dcI;
+  double m_dcQ;
+  double m_powerI;
+  double m_powerQ;
+  double m_crossIQ;
+};
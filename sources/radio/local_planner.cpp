@@ -0,0 +1,91 @@
+#include "local_planner.h"
+
+#include <config.h>
+#include <logger.h>
+#include <utils/cron_expression.h>
+
+#include <algorithm>
+
+constexpr auto LABEL = "local_planner";
+constexpr auto PASS_SEARCH_STEP = std::chrono::seconds(30);      // shorter passes over min elevation can be missed
+constexpr auto PASS_PRECISION = std::chrono::milliseconds(500);  // bisection stops at this step
+
+LocalPlanner::LocalPlanner(double latitude, double longitude, double altitude, double minElevation)
+    : m_latitude(latitude), m_longitude(longitude), m_altitude(altitude), m_minElevation(minElevation) {}
+
+std::vector<ScheduledTransmission> LocalPlanner::plan(
+    const std::vector<Satellite>& satellites, const std::vector<Crontab>& crontabs, const std::map<int, Tle>& tles, std::chrono::milliseconds from, std::chrono::milliseconds to) const {
+  std::vector<ScheduledTransmission> transmissions;
+  for (const auto& crontab : crontabs) {
+    try {
+      planCrontab(crontab, std::chrono::duration_cast<std::chrono::seconds>(from), std::chrono::duration_cast<std::chrono::seconds>(to), transmissions);
+    } catch (const std::exception& exception) {
+      Logger::exception(LABEL, exception, SPDLOG_LOC, "plan crontab failed: {}", crontab.name);
+    }
+  }
+  for (const auto& satellite : satellites) {
+    const auto it = tles.find(satellite.id);
+    if (it == tles.end()) {
+      Logger::warn(LABEL, "missing tle, satellite: {}, id: {}", satellite.name, satellite.id);
+      continue;
+    }
+    try {
+      planSatellite(satellite, it->second, from, to, transmissions);
+    } catch (const std::exception& exception) {
+      Logger::exception(LABEL, exception, SPDLOG_LOC, "plan satellite failed: {}", satellite.name);
+    }
+  }
+  std::stable_sort(transmissions.begin(), transmissions.end(), [](const ScheduledTransmission& t1, const ScheduledTransmission& t2) { return t1.begin < t2.begin; });
+  return transmissions;
+}
+
+void LocalPlanner::planCrontab(const Crontab& crontab, std::chrono::seconds from, std::chrono::seconds to, std::vector<ScheduledTransmission>& transmissions) const {
+  const CronExpression expression(crontab.expression);
+  // windows started before from are still active
+  auto begin = expression.next(from - crontab.duration - std::chrono::seconds(1));
+  while (begin && *begin <= to) {
+    transmissions.push_back({CRONTAB_SOURCE_NAME, crontab.name, *begin, *begin + crontab.duration, crontab.frequency, crontab.bandwidth, crontab.modulation});
+    begin = expression.next(*begin);
+  }
+}
+
+void LocalPlanner::planSatellite(const Satellite& satellite, const Tle& tle, std::chrono::milliseconds from, std::chrono::milliseconds to, std::vector<ScheduledTransmission>& transmissions) const {
+  const Sgp4 sgp4(tle);
+  auto previousTime = from;
+  auto wasVisible = isVisible(sgp4, from);
+  // valid while satellite is visible, pass in progress at from starts at from
+  auto begin = from;
+  for (auto time = from + PASS_SEARCH_STEP; time < to + PASS_SEARCH_STEP; time += PASS_SEARCH_STEP) {
+    const auto visible = isVisible(sgp4, time);
+    if (visible && !wasVisible) {
+      begin = findCrossing(sgp4, time, previousTime);
+    } else if (!visible && wasVisible) {
+      const auto end = findCrossing(sgp4, previousTime, time);
+      transmissions.push_back({
+          SATELLITE_SOURCE_NAME,
+          satellite.name,
+          std::chrono::floor<std::chrono::seconds>(begin),
+          std::chrono::ceil<std::chrono::seconds>(end),
+          satellite.frequency,
+          satellite.bandwidth,
+          satellite.modulation,
+      });
+    }
+    previousTime = time;
+    wasVisible = visible;
+  }
+}
+
+std::chrono::milliseconds LocalPlanner::findCrossing(const Sgp4& sgp4, std::chrono::milliseconds visible, std::chrono::milliseconds hidden) const {
+  while (PASS_PRECISION < std::chrono::abs(visible - hidden)) {
+    const auto middle = visible + (hidden - visible) / 2;
+    if (isVisible(sgp4, middle)) {
+      visible = middle;
+    } else {
+      hidden = middle;
+    }
+  }
+  return visible;
+}
+
+bool LocalPlanner::isVisible(const Sgp4& sgp4, std::chrono::milliseconds time) const { return m_minElevation <= sgp4.getElevation(time, m_latitude, m_longitude, m_altitude); }
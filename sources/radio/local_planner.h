@@ -0,0 +1,31 @@
+#pragma once
+
+#include <network/query.h>
+#include <radio/help_structures.h>
+#include <utils/sgp4.h>
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+// in process replacement of remote scheduler service, plans crontab windows and satellite passes
+class LocalPlanner {
+ public:
+  LocalPlanner(double latitude, double longitude, double altitude, double minElevation);
+
+  // transmissions overlapping [from, to] sorted by begin, satellites missing in tles are skipped
+  std::vector<ScheduledTransmission> plan(
+      const std::vector<Satellite>& satellites, const std::vector<Crontab>& crontabs, const std::map<int, Tle>& tles, std::chrono::milliseconds from, std::chrono::milliseconds to) const;
+
+ private:
+  void planCrontab(const Crontab& crontab, std::chrono::seconds from, std::chrono::seconds to, std::vector<ScheduledTransmission>& transmissions) const;
+  void planSatellite(const Satellite& satellite, const Tle& tle, std::chrono::milliseconds from, std::chrono::milliseconds to, std::vector<ScheduledTransmission>& transmissions) const;
+  // time of horizon crossing between times with different visibility
+  std::chrono::milliseconds findCrossing(const Sgp4& sgp4, std::chrono::milliseconds visible, std::chrono::milliseconds hidden) const;
+  bool isVisible(const Sgp4& sgp4, std::chrono::milliseconds time) const;
+
+  const double m_latitude;
+  const double m_longitude;
+  const double m_altitude;
+  const double m_minElevation;
+};
@@ -3,6 +3,7 @@
 #include <config.h>
 #include <gnuradio/analog/agc2_cc.h>
 #include <gnuradio/blocks/complex_to_interleaved_char.h>
+#include <gnuradio/blocks/complex_to_interleaved_short.h>
 #include <gnuradio/blocks/file_sink.h>
 #include <gnuradio/blocks/stream_to_vector.h>
 #include <gnuradio/filter/fir_filter.h>
@@ -14,42 +15,83 @@
 #include <gnuradio/zeromq/sub_source.h>
 #include <logger.h>
 #include <network/query.h>
+#include <radio/buffer_profile.h>
+#include <tracer.h>
 
 #include <limits>
+#include <stdexcept>
+#include <string_view>
 
 constexpr auto LABEL = "recorder";
 
 // most blocks based on
 // https://github.com/gqrx-sdr/gqrx/blob/master/src/applications/gqrx/receiver.cpp
 
+void setShift(const Block& block, Frequency sampleRate, Frequency shift) {
+  if (const auto filter = std::dynamic_pointer_cast<gr::filter::freq_xlating_fir_filter_ccf>(block)) {
+    filter->set_center_freq(shift);
+  } else if (const auto rotator = std::dynamic_pointer_cast<gr::blocks::rotator_cc>(block)) {
+    rotator->set_phase_inc(2.0l * M_PIl * (static_cast<double>(shift) / static_cast<float>(sampleRate)));
+  }
+}
+
 Block buildDecimator(Frequency sampleRate, Frequency shift, int decim) {
   if (1 < decim) {
     const auto filter = gr::filter::freq_xlating_fir_filter_ccf::make(decim, {1}, 0.0, sampleRate);
     const auto outRate = sampleRate / decim;
     const auto lpf_cutoff = 120e3;
-    filter->set_center_freq(shift);
+    setShift(filter, sampleRate, shift);
     filter->set_taps(gr::filter::firdes::low_pass(1.0, sampleRate, lpf_cutoff, outRate - 2 * lpf_cutoff, gr::fft::window::WIN_BLACKMAN_HARRIS));
     return filter;
   } else {
     auto shiftBlock = gr::blocks::rotator_cc::make();
-    shiftBlock->set_phase_inc(2.0l * M_PIl * (static_cast<double>(shift) / static_cast<float>(sampleRate)));
+    setShift(shiftBlock, sampleRate, shift);
     return shiftBlock;
   }
 }
 
-Block buildResampler(Frequency inputRate, Frequency outputRate) {
+Block buildResampler(Frequency inputRate, Frequency outputRate, int outputMultiple) {
   const auto rate = static_cast<double>(outputRate) / inputRate;
   const auto cutoff = rate > 1.0f ? 0.4 : 0.4 * (double)rate;
   const auto trans_width = rate > 1.0f ? 0.2 : 0.2 * (double)rate;
   const auto flt_size = 32;
   const auto d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
   auto resampler = gr::filter::pfb_arb_resampler_ccf::make(rate, d_taps, flt_size);
-  resampler->set_output_multiple(4096);
+  resampler->set_output_multiple(outputMultiple);
   return resampler;
 }
 
-Recorder::Recorder(const Config& config, const Device& device, const std::string& zeromq, Frequency sampleRate, const Recording& recording, std::function<void(const nlohmann::json&)> send)
-    : m_config(config), m_sampleRate(sampleRate), m_recording(recording), m_send(send), m_tb(gr::make_top_block("recorder")), m_connector(m_tb) {
+// metadata is dumped once with empty data, base64 samples are spliced into its empty string value
+// in single, exactly sized buffer instead of being copied through json
+std::string buildTransmission(const Recording& recording, const std::chrono::milliseconds& time, const SimpleComplex* data, const int size) {
+  const auto header = static_cast<nlohmann::json>(TransmissionQuery(recording.source, recording.name, time, recording.recordingFrequency, recording.bandwidth, recording.modulation, "")).dump();
+  // quotes inside values are escaped, so unescaped pattern matches only data member
+  constexpr std::string_view dataMember = "\"data\":\"\"";
+  const auto position = header.find(dataMember);
+  if (position == std::string::npos) {
+    throw std::runtime_error("transmission json without data member");
+  }
+  const auto splice = position + dataMember.size() - 1;
+
+  std::string out;
+  out.reserve(header.size() + encoded_base64_size<SimpleComplex>(size));
+  out.append(header, 0, splice);
+  append_base64(out, data, size);
+  out.append(header, splice);
+  return out;
+}
+
+Recorder::Recorder(const Config& config, const Device& device, const std::string& zeromq, Frequency sampleRate, const Recording& recording, std::function<void(std::string&&)> send)
+    : m_config(config),
+      m_sampleRate(sampleRate),
+      m_recording(recording),
+      m_send(send),
+      m_doppler(recording.doppler),
+      m_tb(gr::make_top_block("recorder")),
+      m_connector(m_tb),
+      m_sentBytes(0),
+      m_sentBytesMetric(Metrics::counter("sdr_recorder_sent_bytes_total", "transmission payload bytes sent by recorders", {{"device", device.getName()}})) {
+  Tracer::Scope scope("recorder start", "frequency", recording.recordingFrequency);
   Logger::info(
       LABEL,
       "start recorder, source: {}, name: {}, frequency: {}, bandwidth: {}, modulation: {}",
@@ -59,34 +101,58 @@ Recorder::Recorder(const Config& config, const Device& device, const std::string
       formatFrequency(m_recording.bandwidth, GREEN),
       colored(BLUE, "{}", m_recording.modulation));
 
-  auto source = gr::zeromq::sub_source::make(sizeof(gr_complex), 1, const_cast<char*>(zeromq.c_str()));
+  auto source = gr::zeromq::sub_source::make(sizeof(gr_complex), 1, const_cast<char*>(zeromq.c_str()), 100, true);
   std::vector<Block> blocks;
   blocks.push_back(source);
   const auto decim = std::max(1, static_cast<int>(sampleRate / RECORDER_SAMPLE_RATE_DECIMATOR));
-  blocks.push_back(buildDecimator(m_sampleRate, m_recording.shift(), decim));
-  blocks.push_back(buildResampler(sampleRate / decim, m_recording.bandwidth));
+  const BufferProfile bufferProfile(config.bufferProfile(), sampleRate);
+  m_shiftBlock = buildDecimator(m_sampleRate, m_recording.shift() + m_doppler, decim);
+  blocks.push_back(m_shiftBlock);
+  blocks.push_back(buildResampler(sampleRate / decim, m_recording.bandwidth, bufferProfile.recorderOutputMultiple()));
   auto raw = blocks.back();
 
-  const auto samplesSize = roundUp(m_recording.bandwidth * RECORDER_FLUSH_INTERVAL.count() / 1000, 4096);
   blocks.push_back(gr::analog::agc2_cc::make(2e-3, 2e-3, 0.585, 53));
-  blocks.push_back(gr::blocks::complex_to_interleaved_char::make(true, 127.0));
-  blocks.push_back(gr::blocks::stream_to_vector::make(sizeof(SimpleComplex), samplesSize));
-  m_buffer = std::make_shared<Buffer<SimpleComplex>>("RecorderBuffer", samplesSize);
-  blocks.push_back(m_buffer);
+  // blocks after decimator passing samples at recording bandwidth
+  int streamBlocks = 0;
+  if (config.isSigmfSinkEnabled()) {
+    if (config.sigmfFormat() == "ci8") {
+      blocks.push_back(gr::blocks::complex_to_interleaved_char::make(true, 127.0));
+    } else {
+      blocks.push_back(gr::blocks::complex_to_interleaved_short::make(true, 32767.0));
+    }
+    m_sigmfSink = std::make_shared<SigmfSink>(config.sigmfDir(), device, m_recording, config.sigmfFormat(), config.sigmfMaxFileSize(), config.sigmfMaxTotalSize());
+    blocks.push_back(m_sigmfSink);
+    streamBlocks = static_cast<int>(blocks.size());
+  } else {
+    const auto samplesSize = roundUp(m_recording.bandwidth * RECORDER_FLUSH_INTERVAL.count() / 1000, 4096);
+    blocks.push_back(gr::blocks::complex_to_interleaved_char::make(true, 127.0));
+    // items after stream to vector are whole flush intervals, gnuradio defaults fit them
+    streamBlocks = static_cast<int>(blocks.size());
+    blocks.push_back(gr::blocks::stream_to_vector::make(sizeof(SimpleComplex), samplesSize));
+    m_buffer = std::make_shared<Buffer<SimpleComplex>>("RecorderBuffer", device, samplesSize, static_cast<double>(m_recording.bandwidth) / samplesSize);
+    blocks.push_back(m_buffer);
+  }
   m_connector.connect(blocks);
+  bufferProfile.recorder(m_shiftBlock, sampleRate / decim);
+  for (auto i = 2; i < streamBlocks; ++i) {
+    bufferProfile.recorder(blocks[i], m_recording.bandwidth);
+  }
 
   if (config.dumpRecording()) {
     const auto fileName = getRawFileName(config.workDir(), device, "recording", "fc", m_recording.recordingFrequency, m_recording.bandwidth);
     m_connector.connect<Block>(raw, gr::blocks::file_sink::make(sizeof(gr_complex), fileName.c_str()));
   }
 
+  m_connector.setProcessorAffinity(config.recorderCores());
   m_firstDataTime = getTime();
   m_lastDataTime = m_firstDataTime;
   m_tb->start();
 }
 
 Recorder::~Recorder() {
-  Logger::info(LABEL, "stop recorder, frequency: {}, time: {} ms", formatFrequency(m_recording.recordingFrequency, RED), getDuration().count());
+  const auto duration = getDuration().count();
+  const auto bytesPerSecond = 0 < duration ? m_sentBytes * 1000 / duration : 0;
+  Logger::info(LABEL, "stop recorder, frequency: {}, time: {} ms, sent: {} bytes, {} bytes/s", formatFrequency(m_recording.recordingFrequency, RED), duration, m_sentBytes, bytesPerSecond);
   m_tb->stop();
   m_tb->wait();
 }
@@ -94,11 +160,26 @@ Recorder::~Recorder() {
 Recording Recorder::getRecording() const { return m_recording; }
 
 void Recorder::flush() {
+  Tracer::Scope scope("recorder flush", "frequency", m_recording.recordingFrequency);
   m_lastDataTime = getTime();
+  if (m_sigmfSink) {
+    m_sigmfSink->commit();
+    return;
+  }
   m_buffer->popSingleSample([this](const SimpleComplex* data, const int size, const std::chrono::milliseconds& time) {
-    TransmissionQuery transmission(m_recording.source, m_recording.name, time, m_recording.recordingFrequency, m_recording.bandwidth, m_recording.modulation, encode_base64(data, size));
-    m_send(transmission);
+    auto transmission = buildTransmission(m_recording, time, data, size);
+    m_sentBytes += transmission.size();
+    m_sentBytesMetric.inc(transmission.size());
+    m_send(std::move(transmission));
   });
 }
 
+void Recorder::setDoppler(Frequency doppler) {
+  if (doppler == m_doppler) {
+    return;
+  }
+  m_doppler = doppler;
+  setShift(m_shiftBlock, m_sampleRate, m_recording.shift() + m_doppler);
+}
+
 std::chrono::milliseconds Recorder::getDuration() const { return m_lastDataTime - m_firstDataTime; }
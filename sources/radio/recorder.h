@@ -3,7 +3,9 @@
 #include <config.h>
 #include <gnuradio/blocks/rotator_cc.h>
 #include <gnuradio/top_block.h>
+#include <metrics.h>
 #include <radio/blocks/buffer.h>
+#include <radio/blocks/sigmf_sink.h>
 #include <radio/connector.h>
 #include <radio/help_structures.h>
 #include <utils/utils.h>
@@ -18,22 +20,29 @@ class Recorder {
   Recorder(const Recorder&) = delete;
   Recorder& operator=(const Recorder&) = delete;
 
-  Recorder(const Config& config, const Device& device, const std::string& zeromq, Frequency sampleRate, const Recording& recording, std::function<void(const nlohmann::json&)> send);
+  Recorder(const Config& config, const Device& device, const std::string& zeromq, Frequency sampleRate, const Recording& recording, std::function<void(std::string&&)> send);
   ~Recorder();
 
   Recording getRecording() const;
   void flush();
+  // moves recording center by doppler without restarting recorder
+  void setDoppler(Frequency doppler);
   std::chrono::milliseconds getDuration() const;
 
  private:
   const Config& m_config;
   const Frequency m_sampleRate;
   const Recording m_recording;
-  const std::function<void(const nlohmann::json&)> m_send;
+  const std::function<void(std::string&&)> m_send;
+  Frequency m_doppler;
 
   std::shared_ptr<gr::top_block> m_tb;
   std::shared_ptr<Buffer<SimpleComplex>> m_buffer;
+  std::shared_ptr<SigmfSink> m_sigmfSink;
   Connector m_connector;
+  Block m_shiftBlock;
   std::chrono::milliseconds m_firstDataTime;
   std::chrono::milliseconds m_lastDataTime;
+  uint64_t m_sentBytes;
+  Counter& m_sentBytesMetric;
 };
@@ -0,0 +1,48 @@
+#include "schedule_queue.h"
+
+ScheduleQueue::ScheduleQueue() : m_sequence(0) {}
+
+void ScheduleQueue::push(const ScheduledTransmission& transmission) { m_pending.push({transmission, m_sequence++}); }
+
+void ScheduleQueue::clear() {
+  m_pending = {};
+  m_active.clear();
+  m_ends.clear();
+}
+
+void ScheduleQueue::advance(const std::chrono::milliseconds& now) {
+  while (!m_pending.empty() && m_pending.top().transmission.begin <= now) {
+    const auto& pending = m_pending.top();
+    if (now <= pending.transmission.end) {
+      const auto it = m_active.emplace(std::make_pair(pending.transmission.begin, pending.sequence), pending.transmission);
+      m_ends.emplace(pending.transmission.end, it);
+    }
+    m_pending.pop();
+  }
+  while (!m_ends.empty() && m_ends.begin()->first < now) {
+    m_active.erase(m_ends.begin()->second);
+    m_ends.erase(m_ends.begin());
+  }
+}
+
+std::vector<ScheduledTransmission> ScheduleQueue::getActive() const {
+  std::vector<ScheduledTransmission> transmissions;
+  transmissions.reserve(m_active.size());
+  for (const auto& [key, transmission] : m_active) {
+    transmissions.push_back(transmission);
+  }
+  return transmissions;
+}
+
+std::chrono::milliseconds ScheduleQueue::getNextEventTime() const {
+  auto next = std::chrono::milliseconds::max();
+  if (!m_pending.empty()) {
+    next = std::min(next, std::chrono::duration_cast<std::chrono::milliseconds>(m_pending.top().transmission.begin));
+  }
+  if (!m_ends.empty()) {
+    next = std::min(next, std::chrono::duration_cast<std::chrono::milliseconds>(m_ends.begin()->first) + std::chrono::milliseconds(1));
+  }
+  return next;
+}
+
+size_t ScheduleQueue::size() const { return m_pending.size() + m_active.size(); }
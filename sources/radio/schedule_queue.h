@@ -0,0 +1,43 @@
+#pragma once
+
+#include <network/query.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <vector>
+
+// scheduled transmissions waiting in priority queue ordered by begin, active transmissions indexed by begin and end
+// transmission is active when begin <= now <= end, every activation and expiration costs O(log n)
+class ScheduleQueue {
+ public:
+  ScheduleQueue();
+
+  void push(const ScheduledTransmission& transmission);
+  void clear();
+
+  // activates transmissions with begin <= now, drops transmissions with end < now
+  void advance(const std::chrono::milliseconds& now);
+  // active transmissions ordered by begin, equal begins keep push order
+  std::vector<ScheduledTransmission> getActive() const;
+  // earliest pending begin or active expiration, max if empty
+  std::chrono::milliseconds getNextEventTime() const;
+  size_t size() const;
+
+ private:
+  struct Pending {
+    ScheduledTransmission transmission;
+    uint64_t sequence;
+
+    bool operator>(const Pending& other) const {
+      return transmission.begin != other.transmission.begin ? transmission.begin > other.transmission.begin : sequence > other.sequence;
+    }
+  };
+  using Active = std::multimap<std::pair<std::chrono::seconds, uint64_t>, ScheduledTransmission>;
+
+  std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> m_pending;
+  Active m_active;
+  std::multimap<std::chrono::seconds, Active::iterator> m_ends;
+  uint64_t m_sequence;
+};
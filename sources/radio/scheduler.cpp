@@ -1,15 +1,20 @@
 #include "scheduler.h"
 
 #include <radio/help_structures.h>
+#include <radio/local_planner.h>
+#include <utils/thread_utils.h>
 
 #include <chrono>
+#include <fstream>
 #include <functional>
+#include <sstream>
 
 constexpr auto LABEL = "scheduler";
-constexpr auto LOOP_TIMEOUT = std::chrono::milliseconds(100);
 constexpr auto UPDATE_INITIAL_DELAY = std::chrono::seconds(10);
 constexpr auto UPDATE_INTERVAL = std::chrono::minutes(60);
 constexpr auto SHIFT_FREQUENCY = Frequency(100000);
+constexpr auto PLAN_HORIZON = std::chrono::hours(24);
+constexpr auto SPEED_OF_LIGHT = 299792.458;  // km/s
 
 using namespace std::placeholders;
 
@@ -17,75 +22,225 @@ Scheduler::Scheduler(const Config& config, const Device& device, RemoteControlle
     : m_config(config),
       m_device(device),
       m_remoteController(remoteController),
+      m_nextEventTime(std::chrono::milliseconds::max()),
+      m_version(0),
+      m_latitude(0.0),
+      m_longitude(0.0),
+      m_altitude(0.0),
       m_lastUpdateTime(getTime() - UPDATE_INTERVAL + UPDATE_INITIAL_DELAY),
       m_isRefreshEnabled(true),
+      m_isRefreshRequested(false),
       m_isRunning(true),
-      m_thread([this]() { worker(); }) {}
+      m_callbackId(m_remoteController.schedulerCallback(m_device, std::bind(&Scheduler::callback, this, _1))),
+      m_thread([this]() {
+        setThreadName("sched_" + m_device.serial);
+        worker();
+      }) {}
 
 Scheduler::~Scheduler() {
-  m_isRunning = false;
+  m_remoteController.removeCallback(m_callbackId);
+  {
+    std::unique_lock lock(m_mutex);
+    m_isRunning = false;
+  }
+  m_condition.notify_all();
   m_thread.join();
 }
 
-std::vector<ScheduledTransmission> Scheduler::getTransmissions(const std::chrono::milliseconds& now, std::list<ScheduledTransmission>& scheduledTransmissions) {
-  while (!scheduledTransmissions.empty() && scheduledTransmissions.front().end < now) {
-    scheduledTransmissions.pop_front();
-  }
-  std::vector<ScheduledTransmission> transmissions;
-  for (auto it = scheduledTransmissions.begin(); it != scheduledTransmissions.end() && it->begin <= now; ++it) {
-    transmissions.push_back(*it);
-  }
-  return transmissions;
+std::vector<ScheduledTransmission> Scheduler::getTransmissions(const std::chrono::milliseconds& now, ScheduleQueue& scheduledTransmissions) {
+  scheduledTransmissions.advance(now);
+  return scheduledTransmissions.getActive();
 }
 
 std::optional<std::pair<FrequencyRange, std::vector<Recording>>> Scheduler::getRecordings(
-    const std::chrono::milliseconds& now, std::list<ScheduledTransmission>& scheduledTransmissions, Frequency sampleRate, Frequency shift) {
+    const std::chrono::milliseconds& now, ScheduleQueue& scheduledTransmissions, Frequency sampleRate, Frequency shift, const std::vector<FrequencyRange>& ranges) {
   const auto transmissions = getTransmissions(now, scheduledTransmissions);
   if (transmissions.empty()) {
     return std::nullopt;
   }
-  const auto center = transmissions.front().frequency + shift;
-  const auto left = center - sampleRate / 2;
-  const auto right = center + sampleRate / 2;
-  const FrequencyRange range(left, right);
+  const auto isCovered = [sampleRate](const Frequency center, const ScheduledTransmission& transmission) {
+    return center - sampleRate / 2 <= transmission.frequency - transmission.bandwidth / 2 && transmission.frequency + transmission.bandwidth / 2 <= center + sampleRate / 2;
+  };
+
+  // tuning to scanned range keeps its detector running, first transmission has to stay as far from dc as with default shift
+  std::optional<FrequencyRange> range;
+  long coveredCount = 0;
+  for (const auto& candidate : ranges) {
+    const auto center = candidate.center();
+    if (!isCovered(center, transmissions.front()) || std::abs(transmissions.front().frequency - center) < shift) {
+      continue;
+    }
+    const auto count = std::count_if(transmissions.begin(), transmissions.end(), [&](const ScheduledTransmission& transmission) { return isCovered(center, transmission); });
+    if (coveredCount < count) {
+      coveredCount = count;
+      range = candidate;
+    }
+  }
+  if (!range) {
+    const auto center = transmissions.front().frequency + shift;
+    range = FrequencyRange(center - sampleRate / 2, center + sampleRate / 2);
+  }
+
+  const auto center = range->center();
   std::vector<Recording> recordings;
   for (const auto& transmission : transmissions) {
-    const auto transmissionLeft = transmission.frequency - transmission.bandwidth / 2;
-    const auto transmissionRight = transmission.frequency + transmission.bandwidth / 2;
-    if (left <= transmissionLeft && transmissionRight <= right) {
+    if (isCovered(center, transmission)) {
       recordings.emplace_back(transmission.source, transmission.name, center, transmission.frequency, transmission.bandwidth, transmission.modulation, true);
     }
   }
-  return std::pair<FrequencyRange, std::vector<Recording>>(range, recordings);
+  return std::pair<FrequencyRange, std::vector<Recording>>(*range, recordings);
 }
 
-std::optional<std::pair<FrequencyRange, std::vector<Recording>>> Scheduler::getRecordings(const std::chrono::milliseconds& now) {
+std::optional<std::pair<FrequencyRange, std::vector<Recording>>> Scheduler::getRecordings(const std::chrono::milliseconds& now, const std::vector<FrequencyRange>& ranges) {
   std::unique_lock lock(m_mutex);
-  return Scheduler::getRecordings(now, m_scheduledTransmissions, m_device.sample_rate, SHIFT_FREQUENCY);
+  auto recordings = Scheduler::getRecordings(now, m_scheduledTransmissions, m_device.sample_rate, SHIFT_FREQUENCY, ranges);
+  if (recordings) {
+    for (auto& recording : recordings->second) {
+      recording.doppler = getDoppler(recording, now);
+    }
+  }
+  m_nextEventTime = m_scheduledTransmissions.getNextEventTime();
+  return recordings;
+}
+
+std::chrono::milliseconds Scheduler::getNextEventTime() const { return m_nextEventTime; }
+
+void Scheduler::wait(const std::chrono::milliseconds& timeout) {
+  std::unique_lock lock(m_mutex);
+  const auto version = m_version;
+  const auto deadline = std::min(getTime() + timeout, m_nextEventTime.load());
+  m_condition.wait_until(lock, std::chrono::system_clock::time_point(deadline), [this, version]() { return !m_isRunning || m_version != version; });
 }
 
 void Scheduler::worker() {
-  m_remoteController.schedulerCallback(m_device, std::bind(&Scheduler::callback, this, _1));
+  std::unique_lock lock(m_mutex);
   while (m_isRunning) {
     const auto now = getTime();
-    if (m_isRefreshEnabled && m_lastUpdateTime + UPDATE_INTERVAL <= now) {
-      query();
+    if (m_isRefreshEnabled && (m_lastUpdateTime + UPDATE_INTERVAL <= now || m_isRefreshRequested)) {
+      m_isRefreshRequested = false;
       m_lastUpdateTime = now;
+      lock.unlock();
+      query();
+      lock.lock();
+    } else if (m_isRefreshEnabled) {
+      const auto deadline = std::chrono::system_clock::time_point(m_lastUpdateTime + UPDATE_INTERVAL);
+      m_condition.wait_until(lock, deadline, [this]() { return !m_isRunning || !m_isRefreshEnabled || m_isRefreshRequested; });
+    } else {
+      m_condition.wait(lock, [this]() { return !m_isRunning || m_isRefreshEnabled; });
     }
-    std::this_thread::sleep_for(LOOP_TIMEOUT);
   }
 }
 
 void Scheduler::query() {
+  const auto tles = loadTles();
+  if (m_config.isLocalSchedulerEnabled()) {
+    plan(tles);
+    return;
+  }
   Logger::info(LABEL, "send query");
+  std::unique_lock lock(m_mutex);
   const SchedulerQuery query(m_config.latitude(), m_config.longitude(), m_config.altitude(), m_device.satellites, m_device.crontabs);
+  lock.unlock();
   m_remoteController.schedulerQuery(m_device, static_cast<nlohmann::json>(query).dump());
 }
 
+std::map<int, Tle> Scheduler::loadTles() {
+  std::unique_lock lock(m_mutex);
+  const auto satellites = m_device.satellites;
+  lock.unlock();
+
+  std::map<int, Tle> tles;
+  std::map<std::string, Sgp4> trackers;
+  auto latitude = 0.0;
+  auto longitude = 0.0;
+  try {
+    latitude = std::stod(m_config.latitude());
+    longitude = std::stod(m_config.longitude());
+    const auto tleFile = m_config.tleFile();
+    std::ifstream file(tleFile);
+    if (file) {
+      std::stringstream content;
+      content << file.rdbuf();
+      tles = Tle::parseFile(content.str());
+    } else if (m_config.isLocalSchedulerEnabled() && !satellites.empty()) {
+      Logger::warn(LABEL, "missing tle file: {}", tleFile);
+    }
+    for (const auto& satellite : satellites) {
+      const auto it = tles.find(satellite.id);
+      if (it != tles.end()) {
+        trackers.emplace(satellite.name, Sgp4(it->second));
+      }
+    }
+  } catch (const std::exception& exception) {
+    Logger::exception(LABEL, exception, SPDLOG_LOC, "load tle failed");
+  }
+  Logger::info(LABEL, "doppler tracked satellites: {}", colored(GREEN, "{}", trackers.size()));
+
+  lock.lock();
+  m_trackers = std::move(trackers);
+  m_latitude = latitude;
+  m_longitude = longitude;
+  m_altitude = m_config.altitude();
+  return tles;
+}
+
+Frequency Scheduler::getDoppler(const Recording& recording, const std::chrono::milliseconds& now) const {
+  if (recording.source != SATELLITE_SOURCE_NAME) {
+    return 0;
+  }
+  const auto it = m_trackers.find(recording.name);
+  if (it == m_trackers.end()) {
+    return 0;
+  }
+  const auto rangeRate = it->second.getRangeRate(now, m_latitude, m_longitude, m_altitude);
+  return static_cast<Frequency>(std::llround(-static_cast<double>(recording.recordingFrequency) * rangeRate / SPEED_OF_LIGHT));
+}
+
+void Scheduler::plan(const std::map<int, Tle>& tles) {
+  std::unique_lock lock(m_mutex);
+  const auto satellites = m_device.satellites;
+  const auto crontabs = m_device.crontabs;
+  const LocalPlanner planner(m_latitude, m_longitude, m_altitude, m_config.minElevation());
+  lock.unlock();
+
+  const auto now = getTime();
+  const auto transmissions = planner.plan(satellites, crontabs, tles, now, now + PLAN_HORIZON);
+  Logger::info(LABEL, "planned locally, tles: {}, size: {}", colored(GREEN, "{}", tles.size()), colored(GREEN, "{}", transmissions.size()));
+  setTransmissions(transmissions);
+}
+
 void Scheduler::callback(const nlohmann::json& json) {
   Logger::info(LABEL, "received response, size: {}", colored(GREEN, "{}", json.size()));
-  std::unique_lock lock(m_mutex);
-  m_scheduledTransmissions = json;
+  setTransmissions(json.get<std::vector<ScheduledTransmission>>());
+}
+
+void Scheduler::setTransmissions(const std::vector<ScheduledTransmission>& transmissions) {
+  {
+    std::unique_lock lock(m_mutex);
+    m_scheduledTransmissions.clear();
+    for (const auto& transmission : transmissions) {
+      m_scheduledTransmissions.push(transmission);
+    }
+    m_nextEventTime = m_scheduledTransmissions.getNextEventTime();
+    m_version++;
+  }
+  m_condition.notify_all();
 }
 
-void Scheduler::setRefreshEnabled(const bool& enabled) { m_isRefreshEnabled = enabled; }
+void Scheduler::setRefreshEnabled(const bool& enabled) {
+  {
+    std::unique_lock lock(m_mutex);
+    m_isRefreshEnabled = enabled;
+  }
+  m_condition.notify_all();
+}
+
+void Scheduler::update(const Device& device) {
+  {
+    std::unique_lock lock(m_mutex);
+    m_device.satellites = device.satellites;
+    m_device.crontabs = device.crontabs;
+    m_isRefreshRequested = true;
+  }
+  m_condition.notify_all();
+}
@@ -3,9 +3,12 @@
 #include <config.h>
 #include <network/query.h>
 #include <network/remote_controller.h>
+#include <radio/schedule_queue.h>
 #include <radio/sdr_device.h>
+#include <utils/sgp4.h>
 
-#include <list>
+#include <condition_variable>
+#include <map>
 #include <mutex>
 #include <optional>
 
@@ -14,27 +17,48 @@ class Scheduler {
   Scheduler(const Config& config, const Device& device, RemoteController& remoteController);
   ~Scheduler();
 
-  static std::vector<ScheduledTransmission> getTransmissions(const std::chrono::milliseconds& now, std::list<ScheduledTransmission>& scheduledTransmissions);
+  static std::vector<ScheduledTransmission> getTransmissions(const std::chrono::milliseconds& now, ScheduleQueue& scheduledTransmissions);
+  // prefers tuning to one of scanned ranges covering scheduled transmissions, otherwise shifts center from first transmission
   static std::optional<std::pair<FrequencyRange, std::vector<Recording>>> getRecordings(
-      const std::chrono::milliseconds& now, std::list<ScheduledTransmission>& scheduledTransmissions, Frequency sampleRate, Frequency shift);
-  std::optional<std::pair<FrequencyRange, std::vector<Recording>>> getRecordings(const std::chrono::milliseconds& now);
+      const std::chrono::milliseconds& now, ScheduleQueue& scheduledTransmissions, Frequency sampleRate, Frequency shift, const std::vector<FrequencyRange>& ranges = {});
+  std::optional<std::pair<FrequencyRange, std::vector<Recording>>> getRecordings(const std::chrono::milliseconds& now, const std::vector<FrequencyRange>& ranges);
+  // lock free, recordings can change only at or after this time
+  std::chrono::milliseconds getNextEventTime() const;
+  // sleeps until timeout, next scheduled begin or end, or schedule update
+  void wait(const std::chrono::milliseconds& timeout);
 
   void setRefreshEnabled(const bool& enabled);
+  // replaces satellites and crontabs, query is sent at next refresh
+  void update(const Device& device);
 
  private:
   void worker();
-  void mergeScheduledTransmissions();
 
   void query();
+  // reloads tle file and satellite trackers used for doppler correction
+  std::map<int, Tle> loadTles();
+  Frequency getDoppler(const Recording& recording, const std::chrono::milliseconds& now) const;
+  // local mode, crontabs and satellite passes are planned without remote service
+  void plan(const std::map<int, Tle>& tles);
   void callback(const nlohmann::json& json);
+  void setTransmissions(const std::vector<ScheduledTransmission>& transmissions);
 
   const Config& m_config;
-  const Device m_device;
+  Device m_device;
   RemoteController& m_remoteController;
-  std::list<ScheduledTransmission> m_scheduledTransmissions;
+  ScheduleQueue m_scheduledTransmissions;
+  std::atomic<std::chrono::milliseconds> m_nextEventTime;
+  uint64_t m_version;
+  std::map<std::string, Sgp4> m_trackers;
+  double m_latitude;
+  double m_longitude;
+  double m_altitude;
   std::chrono::milliseconds m_lastUpdateTime;
-  std::atomic<bool> m_isRefreshEnabled;
-  std::atomic<bool> m_isRunning;
-  std::thread m_thread;
+  bool m_isRefreshEnabled;
+  bool m_isRefreshRequested;
+  bool m_isRunning;
   std::mutex m_mutex;
+  std::condition_variable m_condition;
+  const Mqtt::CallbackId m_callbackId;
+  std::thread m_thread;
 };
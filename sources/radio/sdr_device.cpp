@@ -2,7 +2,6 @@
 
 #include <config.h>
 #include <gnuradio/block_detail.h>
-#include <gnuradio/blocks/copy.h>
 #include <gnuradio/blocks/file_sink.h>
 #include <gnuradio/blocks/null_sink.h>
 #include <gnuradio/soapy/source.h>
@@ -11,54 +10,83 @@
 #include <network/remote_controller.h>
 #include <notification.h>
 #include <radio/blocks/sdr_source.h>
+#include <radio/buffer_profile.h>
 #include <radio/help_structures.h>
 #include <radio/recorder.h>
 #include <radio/sdr_processor.h>
+#include <tracer.h>
 
 #include <filesystem>
 
 constexpr auto LABEL = "sdr";
 
-SdrDevice::SdrDevice(const Config& config, const Device& device, RemoteController& remoteController, TransmissionNotification& notification, const std::vector<FrequencyRange>& ranges)
+SdrDevice::SdrDevice(
+    const Config& config,
+    const Device& device,
+    RemoteController& remoteController,
+    TransmissionNotification& notification,
+    const std::vector<FrequencyRange>& ranges,
+    const std::vector<FrequencyRange>& interest)
     : m_config(config),
       m_device(device),
+      m_detection(config, m_device),
       m_zeromq(fmt::format("ipc://{}/{}_{}_zeromq_stream.sock", std::filesystem::canonical(m_config.workDir()).string(), device.driver, device.serial)),
       m_remoteController(remoteController),
       m_notification(notification),
       m_isInitialized(false),
+      m_spectrogramLease(std::make_shared<SpectrogramLease>(SPECTROGRAM_LEASE_TIME)),
+      m_spectrogramCallback(0),
       m_tb(gr::make_top_block("device")),
-      m_source(std::make_shared<SdrSource>(device)),
+      m_source(std::make_shared<SdrSource>(device, config.sourcePriority())),
+      m_corrector(device.iq_correction ? std::make_shared<IqCorrector>(device, device.sample_rate) : nullptr),
       m_selector(gr::blocks::selector::make(sizeof(gr_complex), 0, 0)),
-      m_connector(m_tb) {
+      m_connector(m_tb),
+      m_selectorConnector(m_tb),
+      m_retunes(Metrics::counter("sdr_retunes_total", "device center frequency changes", {{"device", device.getName()}})),
+      m_retuneFailures(Metrics::counter("sdr_retune_failures_total", "failed device center frequency changes", {{"device", device.getName()}})),
+      m_retuneTime(Metrics::histogram("sdr_retune_seconds", "device center frequency change duration", {{"device", device.getName()}})),
+      m_activeRecorders(Metrics::gauge("sdr_active_recorders", "running recorders", {{"device", device.getName()}})),
+      m_recorderFlushMetrics("RecorderFlush", device) {
   Logger::info(LABEL, "starting");
   Logger::info(LABEL, "driver: {}, serial: {}, sample rate: {}", colored(GREEN, "{}", device.driver), colored(GREEN, "{}", device.serial), formatFrequency(device.sample_rate));
   Logger::info(LABEL, "zeromq: {}", colored(GREEN, "{}", m_zeromq));
 
-  m_connector.connect<Block>(m_source, gr::zeromq::pub_sink::make(sizeof(gr_complex), 1, const_cast<char*>(m_zeromq.c_str())));
-  m_connector.connect<Block>(m_source, m_selector, gr::blocks::null_sink::make(sizeof(gr_complex)));
-
-  int index = 1;
-  for (const auto& range : ranges) {
-    Logger::info(LABEL, "creating processor, index: {}, range: {}", index, formatFrequencyRange(range, GREEN));
-    auto forward = gr::blocks::copy::make(sizeof(gr_complex));
-    auto processor = std::make_unique<SdrProcessor>(m_config, m_device, m_remoteController, m_notification, forward, m_connector, range);
-    m_connector.connect(m_selector, forward, index, 0);
-    m_processors.push_back(std::move(processor));
-    m_processorIndex[range.center()] = index++;
+  m_spectrogramCallback = m_remoteController.spectrogramSubscribeCallback(m_device, [lease = m_spectrogramLease](const std::string&) {
+    if (lease->renew(getTime())) {
+      Logger::info(LABEL, "spectrogram subscribed, lease time: {}", colored(GREEN, "{} s", SPECTROGRAM_LEASE_TIME.count()));
+    }
+  });
+  Logger::info(LABEL, "iq correction: {}", colored(GREEN, "{}", device.iq_correction));
+  const Block input = m_corrector ? Block(m_corrector) : Block(m_source);
+  if (m_corrector) {
+    m_connector.connect<Block>(m_source, m_corrector);
   }
+  m_connector.connect<Block>(input, gr::zeromq::pub_sink::make(sizeof(gr_complex), 1, const_cast<char*>(m_zeromq.c_str()), 100, true));
+  m_connector.connect<Block>(input, m_selector, gr::blocks::null_sink::make(sizeof(gr_complex)));
+  const BufferProfile bufferProfile(config.bufferProfile(), device.sample_rate);
+  bufferProfile.source(m_source);
+  if (m_corrector) {
+    bufferProfile.source(m_corrector);
+  }
+  bufferProfile.stream(m_selector);
+  Logger::info(LABEL, "buffer profile: {}, buffering latency: {}", colored(GREEN, "{}", bufferProfile.name()), colored(GREEN, "{} ms", bufferProfile.bufferingLatency().count()));
+  updateRanges(ranges, interest, false);
 
   if (config.dumpSource()) {
     const auto fileName = getRawFileName(config.workDir(), device, "source-all", "fc", ranges.front().center(), device.sample_rate);
     m_connector.connect<Block>(m_source, gr::blocks::file_sink::make(sizeof(gr_complex), fileName.c_str()));
   }
 
+  m_connector.setProcessorAffinity(device.cores);
   m_tb->start();
   Logger::info(LABEL, "started");
 }
 
 SdrDevice::~SdrDevice() {
+  m_remoteController.removeCallback(m_spectrogramCallback);
   m_tb->stop();
   m_tb->wait();
+  m_activeRecorders.set(0);
   std::remove(m_zeromq.c_str());
   Logger::info(LABEL, "stopped");
 }
@@ -73,9 +101,19 @@ void SdrDevice::setFrequencyRange(FrequencyRange frequencyRange) {
 
   m_selector->set_output_index(0);
   const auto frequency = frequencyRange.center();
-  if (m_source->setCenterFrequency(frequency)) {
+  const auto isTuned = [this, frequency]() {
+    HistogramTimer timer(m_retuneTime);
+    Tracer::Scope scope("retune", "frequency", frequency);
+    return m_source->setCenterFrequency(frequency);
+  }();
+  if (m_corrector) {
+    m_corrector->setFrequency(frequency);
+  }
+  m_retunes.inc();
+  if (isTuned) {
     Logger::debug(LABEL, "set frequency range: {}, center frequency: {}", formatFrequencyRange(frequencyRange), formatFrequency(frequency));
   } else {
+    m_retuneFailures.inc();
     Logger::warn(LABEL, "set frequency range failed: {}, center frequency: {}", formatFrequencyRange(frequencyRange), formatFrequency(frequency));
   }
   std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -85,6 +123,39 @@ void SdrDevice::setFrequencyRange(FrequencyRange frequencyRange) {
   }
 }
 
+void SdrDevice::updateRanges(const std::vector<FrequencyRange>& ranges, const std::vector<FrequencyRange>& interest, bool rebuild) {
+  rebuild = rebuild || interest != m_interest;
+  m_interest = interest;
+  const auto isSpectrogramEnabled = [lease = m_spectrogramLease]() { return lease->isActive(getTime()); };
+  const auto isRangeRemoved = [&ranges, rebuild](const std::unique_ptr<SdrProcessor>& processor) {
+    return rebuild || std::find(ranges.begin(), ranges.end(), processor->getFrequencyRange()) == ranges.end();
+  };
+
+  SdrProcessor::prepare(m_config, m_device);
+  m_tb->lock();
+  m_selector->set_output_index(0);
+  m_selectorConnector.clear();
+  m_processorIndex.clear();
+  std::erase_if(m_processors, isRangeRemoved);
+
+  int index = 1;
+  std::vector<std::unique_ptr<SdrProcessor>> processors;
+  for (const auto& range : ranges) {
+    auto it = std::find_if(m_processors.begin(), m_processors.end(), [range](const std::unique_ptr<SdrProcessor>& processor) { return processor && processor->getFrequencyRange() == range; });
+    if (it != m_processors.end()) {
+      Logger::info(LABEL, "reusing processor, index: {}, range: {}", index, formatFrequencyRange(range, GREEN));
+      processors.push_back(std::move(*it));
+    } else {
+      Logger::info(LABEL, "creating processor, index: {}, range: {}", index, formatFrequencyRange(range, GREEN));
+      processors.push_back(std::make_unique<SdrProcessor>(m_config, m_device, m_remoteController, m_notification, m_tb, range, m_interest, isSpectrogramEnabled));
+    }
+    m_selectorConnector.connect(m_selector, processors.back()->getInput(), index, 0);
+    m_processorIndex[range.center()] = index++;
+  }
+  m_processors = std::move(processors);
+  m_tb->unlock();
+}
+
 void SdrDevice::updateRecordings(const std::vector<Recording> recordings) {
   const auto findRecorder = [this](const Recording& recording) {
     return std::find_if(m_recorders.begin(), m_recorders.end(), [recording](const std::unique_ptr<Recorder>& recorder) {
@@ -100,23 +171,27 @@ void SdrDevice::updateRecordings(const std::vector<Recording> recordings) {
            }) != recordings.end();
   };
 
+  m_detection.refresh();
+  const auto recordersCount = static_cast<size_t>(m_detection.get().recordersCount);
   std::erase_if(m_recorders, [isRecordingActive](const std::unique_ptr<Recorder>& recorder) { return !isRecordingActive(recorder->getRecording()); });
 
-  if (m_recorders.size() < static_cast<size_t>(m_config.recordersCount())) {
+  if (m_recorders.size() < recordersCount) {
     ignoredTransmissions.clear();
   }
 
   for (const auto& recording : recordings) {
     const auto it = findRecorder(recording);
     if (it != m_recorders.end()) {
+      (*it)->setDoppler(recording.doppler);
       if (recording.flush) {
+        const auto timer = m_recorderFlushMetrics.measure();
         (*it)->flush();
       }
     } else {
-      if (m_recorders.size() < static_cast<size_t>(m_config.recordersCount())) {
+      if (m_recorders.size() < recordersCount) {
         const auto sampleRate = m_device.sample_rate;
-        m_recorders.push_back(
-            std::make_unique<Recorder>(m_config, m_device, m_zeromq, sampleRate, recording, std::bind(&RemoteController::sendTransmission, m_remoteController, m_device, std::placeholders::_1)));
+        const auto send = [this](std::string&& data) { m_remoteController.sendTransmission(m_device, std::move(data)); };
+        m_recorders.push_back(std::make_unique<Recorder>(m_config, m_device, m_zeromq, sampleRate, recording, send));
       } else {
         if (!ignoredTransmissions.count(recording.recordingFrequency)) {
           Logger::info(LABEL, "maximum recorders limit reached, frequency: {}", formatFrequency(recording.recordingFrequency, RED));
@@ -125,4 +200,5 @@ void SdrDevice::updateRecordings(const std::vector<Recording> recordings) {
       }
     }
   }
+  m_activeRecorders.set(m_recorders.size());
 }
@@ -2,39 +2,64 @@
 
 #include <gnuradio/blocks/selector.h>
 #include <gnuradio/top_block.h>
+#include <metrics.h>
 #include <network/remote_controller.h>
 #include <notification.h>
+#include <radio/blocks/block_metrics.h>
+#include <radio/blocks/iq_corrector.h>
 #include <radio/blocks/sdr_source.h>
 #include <radio/help_structures.h>
 #include <radio/recorder.h>
 #include <radio/sdr_processor.h>
+#include <radio/spectrogram_lease.h>
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
 
 class SdrDevice {
  public:
-  SdrDevice(const Config& config, const Device& device, RemoteController& remoteController, TransmissionNotification& notification, const std::vector<FrequencyRange>& ranges);
+  SdrDevice(
+      const Config& config,
+      const Device& device,
+      RemoteController& remoteController,
+      TransmissionNotification& notification,
+      const std::vector<FrequencyRange>& ranges,
+      const std::vector<FrequencyRange>& interest);
   ~SdrDevice();
 
   void setFrequencyRange(FrequencyRange frequencyRange);
+  // rebuilds processors of changed ranges without stopping source, rebuild or changed interest forces all processors
+  // ranges are tunings centered on tuned frequency, detection is limited to interest inside them
+  void updateRanges(const std::vector<FrequencyRange>& ranges, const std::vector<FrequencyRange>& interest, bool rebuild);
   void updateRecordings(const std::vector<Recording> recordings);
 
  private:
   const Config& m_config;
   const Device m_device;
+  DetectionSnapshot m_detection;
   const std::string m_zeromq;
   RemoteController& m_remoteController;
   TransmissionNotification& m_notification;
   bool m_isInitialized;
+  std::shared_ptr<SpectrogramLease> m_spectrogramLease;
+  Mqtt::CallbackId m_spectrogramCallback;
 
   std::shared_ptr<gr::top_block> m_tb;
   std::shared_ptr<SdrSource> m_source;
+  std::shared_ptr<IqCorrector> m_corrector;
   std::shared_ptr<gr::blocks::selector> m_selector;
   Connector m_connector;
+  Connector m_selectorConnector;
   std::vector<std::unique_ptr<SdrProcessor>> m_processors;
+  std::vector<FrequencyRange> m_interest;
   std::map<Frequency, int> m_processorIndex;
   std::vector<std::unique_ptr<Recorder>> m_recorders;
   std::set<Frequency> ignoredTransmissions;
+  Counter& m_retunes;
+  Counter& m_retuneFailures;
+  Histogram& m_retuneTime;
+  Gauge& m_activeRecorders;
+  BlockMetrics m_recorderFlushMetrics;
 };
@@ -2,6 +2,7 @@
 
 #include <config.h>
 #include <logger.h>
+#include <utils/file_utils.h>
 #include <utils/utils.h>
 
 constexpr auto LABEL = "sdr_reader";
@@ -46,21 +47,23 @@ std::vector<Gain> getGains(SoapySDR::Device* sdr) {
   return gains;
 }
 
-void SdrDeviceReader::updateDevice(Device& device, const SoapySDR::Kwargs args) {
+nlohmann::json SdrDeviceReader::readCapabilities(SoapySDR::Device* sdr) {
+  nlohmann::json json;
+  json["sample_rates"] = getSampleRates(sdr);
+  json["gains"] = getGains(sdr);
+  return json;
+}
+
+void SdrDeviceReader::updateDevice(Device& device, const SoapySDR::Kwargs args, const nlohmann::json& capabilities) {
   const auto serial = args.at("serial");
   const auto driver = args.at("driver");
   Logger::info(LABEL, "update device, driver: {}, serial: {}", colored(GREEN, "{}", driver), colored(GREEN, "{}", serial));
 
-  SoapySDR::Device* sdr = SoapySDR::Device::make(args);
-  if (sdr == nullptr) {
-    throw std::runtime_error("open device failed");
-  }
-
   device.connected = true;
   device.driver = driver;
-  device.sample_rates = getSampleRates(sdr);
+  device.sample_rates = capabilities.at("sample_rates").get<std::vector<Frequency>>();
   const auto backupGains = device.gains;
-  device.gains = getGains(sdr);
+  device.gains = capabilities.at("gains").get<std::vector<Gain>>();
   for (auto& gain : device.gains) {
     for (auto& backupGain : backupGains) {
       if (gain.name == backupGain.name) {
@@ -68,20 +71,13 @@ void SdrDeviceReader::updateDevice(Device& device, const SoapySDR::Kwargs args)
       }
     }
   }
-
-  SoapySDR::Device::unmake(sdr);
 }
 
-Device SdrDeviceReader::createDevice(const SoapySDR::Kwargs args) {
+Device SdrDeviceReader::createDevice(const SoapySDR::Kwargs args, const nlohmann::json& capabilities) {
   const auto serial = args.at("serial");
   const auto driver = args.at("driver");
   Logger::info(LABEL, "creating device, driver: {}, serial: {}", colored(GREEN, "{}", driver), colored(GREEN, "{}", serial));
 
-  SoapySDR::Device* sdr = SoapySDR::Device::make(args);
-  if (sdr == nullptr) {
-    throw std::runtime_error("open device failed");
-  }
-
   Device device;
   device.connected = true;
   device.driver = driver;
@@ -89,8 +85,11 @@ Device SdrDeviceReader::createDevice(const SoapySDR::Kwargs args) {
   device.enabled = true;
   device.start_recording_level = DEFAULT_RECORDING_START_LEVEL;
   device.stop_recording_level = DEFAULT_RECORDING_STOP_LEVEL;
-  device.sample_rates = getSampleRates(sdr);
-  device.gains = getGains(sdr);
+  device.sample_rates = capabilities.at("sample_rates").get<std::vector<Frequency>>();
+  device.gains = capabilities.at("gains").get<std::vector<Gain>>();
+  if (device.sample_rates.empty()) {
+    throw std::runtime_error("empty sample rates");
+  }
 
   auto addSampleRate = [&device](Frequency start, Frequency stop, Frequency sampleRate) {
     const auto contains = std::find(device.sample_rates.begin(), device.sample_rates.end(), sampleRate) != device.sample_rates.end();
@@ -107,11 +106,43 @@ Device SdrDeviceReader::createDevice(const SoapySDR::Kwargs args) {
   addSampleRate(144000000, 146000000, 1024000);
   addSampleRate(144000000, 146000000, 1000000);
   addSampleRate(144000000, 146000000, *device.sample_rates.rbegin());
-
-  SoapySDR::Device::unmake(sdr);
   return device;
 }
 
+void SdrDeviceReader::probeDevices(const SoapySDR::KwargsList& results, nlohmann::json& cache) {
+  const auto probe = [&cache](const SoapySDR::Kwargs& args, SoapySDR::Device* sdr) {
+    Logger::info(LABEL, "probe device, driver: {}, serial: {}", colored(GREEN, "{}", args.at("driver")), colored(GREEN, "{}", args.at("serial")));
+    cache[getCacheKey(args)] = readCapabilities(sdr);
+  };
+
+  try {
+    // soapy opens list of devices in parallel
+    const auto sdrs = SoapySDR::Device::make(results);
+    for (size_t i = 0; i < results.size(); ++i) {
+      probe(results[i], sdrs[i]);
+    }
+    SoapySDR::Device::unmake(sdrs);
+    return;
+  } catch (const std::exception& exception) {
+    Logger::exception(LABEL, exception, SPDLOG_LOC, "parallel probe failed, probing one by one");
+  }
+
+  for (const auto& args : results) {
+    try {
+      SoapySDR::Device* sdr = SoapySDR::Device::make(args);
+      if (sdr == nullptr) {
+        throw std::runtime_error("open device failed");
+      }
+      probe(args, sdr);
+      SoapySDR::Device::unmake(sdr);
+    } catch (const std::exception& exception) {
+      Logger::exception(LABEL, exception, SPDLOG_LOC, "probe device failed");
+    }
+  }
+}
+
+std::string SdrDeviceReader::getCacheKey(const SoapySDR::Kwargs& args) { return args.at("driver") + "_" + args.at("serial"); }
+
 SoapySDR::KwargsList SdrDeviceReader::enumerateDevices(bool enumerateRemote) {
   SoapySDR::KwargsList results = SoapySDR::Device::enumerate(enumerateRemote ? "" : "remote=");
   Logger::info(LABEL, "total devices: {}", colored(GREEN, "{}", results.size()));
@@ -133,24 +164,47 @@ SoapySDR::KwargsList SdrDeviceReader::enumerateDevices(bool enumerateRemote) {
   return results;
 }
 
-void SdrDeviceReader::updateDevices(std::vector<Device>& devices, bool enumerateRemote) {
+void SdrDeviceReader::updateDevices(std::vector<Device>& devices, bool enumerateRemote, const std::string& cacheFile, bool probe) {
   Logger::info(LABEL, "scanning connected devices");
+  const auto startTime = getTime();
   const SoapySDR::KwargsList results = enumerateDevices(enumerateRemote);
+  const auto enumerateTime = getTime();
+
+  auto cache = readFromFile(cacheFile, nlohmann::json::object());
+  SoapySDR::KwargsList uncached;
+  for (const auto& args : results) {
+    if (probe || !cache.contains(getCacheKey(args))) {
+      uncached.push_back(args);
+    }
+  }
+  if (!uncached.empty()) {
+    probeDevices(uncached, cache);
+    saveToFile(cacheFile, cache);
+  }
+  const auto probeTime = getTime();
 
   for (const auto& args : results) {
     try {
       const auto serial = args.at("serial");
+      const auto& capabilities = cache.at(getCacheKey(args));
       const auto f = [serial](const Device& device) { return device.serial == serial; };
       const auto it = std::find_if(devices.begin(), devices.end(), f);
       if (it != devices.end()) {
-        updateDevice(*it, args);
+        updateDevice(*it, args, capabilities);
       } else {
-        devices.push_back(createDevice(args));
+        devices.push_back(createDevice(args, capabilities));
       }
     } catch (const std::exception& exception) {
       Logger::exception(LABEL, exception, SPDLOG_LOC, "update device failed");
     }
   }
+  Logger::info(
+      LABEL,
+      "scanning finished, enumerate: {}, probe: {}, probed devices: {}, cached devices: {}",
+      colored(GREEN, "{} ms", (enumerateTime - startTime).count()),
+      colored(GREEN, "{} ms", (probeTime - enumerateTime).count()),
+      colored(GREEN, "{}", uncached.size()),
+      colored(GREEN, "{}", results.size() - uncached.size()));
 }
 
 void SdrDeviceReader::clearDevices(nlohmann::json& json) {
@@ -8,11 +8,15 @@
 
 class SdrDeviceReader {
  private:
-  static void updateDevice(Device& device, const SoapySDR::Kwargs args);
-  static Device createDevice(const SoapySDR::Kwargs args);
+  static nlohmann::json readCapabilities(SoapySDR::Device* sdr);
+  static void updateDevice(Device& device, const SoapySDR::Kwargs args, const nlohmann::json& capabilities);
+  static Device createDevice(const SoapySDR::Kwargs args, const nlohmann::json& capabilities);
+  static void probeDevices(const SoapySDR::KwargsList& results, nlohmann::json& cache);
+  static std::string getCacheKey(const SoapySDR::Kwargs& args);
   static SoapySDR::KwargsList enumerateDevices(bool enumerateRemote);
 
  public:
-  static void updateDevices(std::vector<Device>& devices, bool enumerateRemote);
+  // sample rates and gains are read from cache file, devices are opened only if missing in cache or probe is set
+  static void updateDevices(std::vector<Device>& devices, bool enumerateRemote, const std::string& cacheFile, bool probe);
   static void clearDevices(nlohmann::json& json);
 };
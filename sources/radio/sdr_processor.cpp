@@ -1,30 +1,38 @@
 #include "sdr_processor.h"
 
+#include <gnuradio/blocks/copy.h>
 #include <gnuradio/blocks/file_sink.h>
 #include <gnuradio/blocks/float_to_char.h>
 #include <gnuradio/blocks/stream_to_vector.h>
-#include <gnuradio/fft/fft_v.h>
 #include <gnuradio/fft/window.h>
 #include <network/query.h>
 #include <radio/blocks/decimator.h>
+#include <radio/blocks/fft.h>
 #include <radio/blocks/noise_learner.h>
 #include <radio/blocks/psd.h>
 #include <radio/blocks/spectrogram.h>
 #include <radio/blocks/transmission.h>
+#include <radio/buffer_profile.h>
 #include <utils/radio_utils.h>
 #include <utils/utils.h>
 
 constexpr auto LABEL = "processor";
 
+void SdrProcessor::prepare(const Config& config, const Device& device) {
+  const BufferProfile bufferProfile(config.bufferProfile(), device.sample_rate);
+  Fft::prepare(config, getFft(device.sample_rate, SIGNAL_DETECTION_MAX_STEP), bufferProfile.fftBatch());
+}
+
 SdrProcessor::SdrProcessor(
     const Config& config,
     const Device& device,
     RemoteController& remoteController,
     TransmissionNotification& notification,
-    std::shared_ptr<gr::block> source,
-    Connector& connector,
-    const FrequencyRange& frequencyRange)
-    : m_connector(connector) {
+    std::shared_ptr<gr::top_block> tb,
+    const FrequencyRange& frequencyRange,
+    const std::vector<FrequencyRange>& interest,
+    std::function<bool()> isSpectrogramEnabled)
+    : m_frequencyRange(frequencyRange), m_input(gr::blocks::copy::make(sizeof(gr_complex))), m_connector(tb) {
   const auto getFrequency = [frequencyRange]() { return frequencyRange.center(); };
   const auto sampleRate = device.sample_rate;
   const auto sendSpectrogram = [&remoteController, device, sampleRate](const std::chrono::milliseconds& time, const Frequency& frequency, const std::vector<int8_t>& data) {
@@ -36,26 +44,47 @@ SdrProcessor::SdrProcessor(
   const auto step = static_cast<double>(sampleRate) / fftSize;
   const auto indexStep = static_cast<Frequency>(std::ceil(config.recordingBandwidth() / (static_cast<double>(sampleRate) / fftSize)));
   const auto decimatorFactor = std::max(1, static_cast<int>(step / SIGNAL_DETECTION_FPS));
+  const auto itemRate = static_cast<double>(sampleRate) / (fftSize * decimatorFactor);
   const auto indexToFrequency = [sampleRate, frequencyRange, step](const int index) { return frequencyRange.center() + static_cast<Frequency>(step * (index + 0.5)) - sampleRate / 2; };
   const auto indexToShift = [sampleRate, step](const int index) { return static_cast<Frequency>(step * (index + 0.5)) - sampleRate / 2; };
-  const auto isIndexInRange = [frequencyRange, indexToFrequency](const int index) { return frequencyRange.contains(indexToFrequency(index)); };
+  // tuning may cover gaps between scanned ranges and dc spike placed in them
+  std::vector<FrequencyRange> detectionRanges;
+  for (const auto& range : interest) {
+    if (range.start < frequencyRange.stop && frequencyRange.start < range.stop) {
+      detectionRanges.emplace_back(std::max(range.start, frequencyRange.start), std::min(range.stop, frequencyRange.stop));
+    }
+  }
+  const auto isIndexInRange = [detectionRanges, indexToFrequency](const int index) {
+    const auto frequency = indexToFrequency(index);
+    return std::any_of(detectionRanges.begin(), detectionRanges.end(), [frequency](const FrequencyRange& range) { return range.contains(frequency); });
+  };
   Logger::info(LABEL, "signal detection, fft: {}, step: {}, decimator factor: {}", colored(GREEN, "{}", fftSize), formatFrequency(step), colored(GREEN, "{}", decimatorFactor));
 
   const auto s2c = gr::blocks::stream_to_vector::make(sizeof(gr_complex), fftSize * decimatorFactor);
-  const auto decimator = std::make_shared<Decimator<gr_complex>>(fftSize, decimatorFactor);
-  const auto fft = gr::fft::fft_v<gr_complex, true>::make(fftSize, gr::fft::window::hamming(fftSize), true);
-  const auto psd = std::make_shared<PSD>(fftSize, sampleRate);
-  const auto noiseLearner = std::make_shared<NoiseLearner>(fftSize, getFrequency, indexToFrequency);
-  const auto transmission = std::make_shared<Transmission>(config, device, fftSize, indexStep, notification, getFrequency, indexToFrequency, indexToShift, isIndexInRange);
-  m_connector.connect<Block>(source, s2c, decimator, fft, psd, noiseLearner, transmission);
-
-  const auto spectrogram = std::make_shared<Spectrogram>(fftSize, sampleRate, getFrequency, sendSpectrogram);
+  const auto decimator = std::make_shared<Decimator<gr_complex>>(device, frequencyRange, fftSize, decimatorFactor);
+  const BufferProfile bufferProfile(config.bufferProfile(), sampleRate);
+  const auto fft = std::make_shared<Fft>(config, device, frequencyRange, fftSize, gr::fft::window::hamming(fftSize), bufferProfile.fftBatch());
+  const auto psd = std::make_shared<PSD>(device, frequencyRange, fftSize, sampleRate);
+  const auto noiseLearner = std::make_shared<NoiseLearner>(device, frequencyRange, fftSize, getFrequency, indexToFrequency);
+  const auto transmission = std::make_shared<Transmission>(config, device, frequencyRange, fftSize, indexStep, itemRate, notification, getFrequency, indexToFrequency, indexToShift, isIndexInRange);
+  m_connector.connect<Block>(m_input, s2c, decimator, fft, psd, noiseLearner, transmission);
+  bufferProfile.stream(m_input);
+  for (const auto& block : std::vector<Block>{s2c, decimator, fft, psd, noiseLearner}) {
+    bufferProfile.frames(block);
+  }
+
+  const auto spectrogram = std::make_shared<Spectrogram>(device, frequencyRange, fftSize, sampleRate, itemRate, getFrequency, isSpectrogramEnabled, sendSpectrogram);
   m_connector.connect<Block>(psd, spectrogram);
 
   if (config.dumpSource()) {
     const auto fileName = getRawFileName(config.workDir(), device, "source", "fc", frequencyRange.center(), device.sample_rate);
-    m_connector.connect<Block>(source, gr::blocks::file_sink::make(sizeof(gr_complex), fileName.c_str()));
+    m_connector.connect<Block>(m_input, gr::blocks::file_sink::make(sizeof(gr_complex), fileName.c_str()));
   }
+  m_connector.setProcessorAffinity(device.cores);
 }
 
 SdrProcessor::~SdrProcessor() = default;
+
+FrequencyRange SdrProcessor::getFrequencyRange() const { return m_frequencyRange; }
+
+Block SdrProcessor::getInput() const { return m_input; }
@@ -10,16 +10,25 @@
 
 class SdrProcessor {
  public:
+  // slow one time setup shared by processors of device, call before flowgraph lock
+  static void prepare(const Config& config, const Device& device);
+
   SdrProcessor(
       const Config& config,
       const Device& device,
       RemoteController& remoteController,
       TransmissionNotification& notification,
-      std::shared_ptr<gr::block> source,
-      Connector& connector,
-      const FrequencyRange& frequencyRange);
+      std::shared_ptr<gr::top_block> tb,
+      const FrequencyRange& frequencyRange,
+      const std::vector<FrequencyRange>& interest,
+      std::function<bool()> isSpectrogramEnabled);
   ~SdrProcessor();
 
+  FrequencyRange getFrequencyRange() const;
+  Block getInput() const;
+
  private:
-  Connector& m_connector;
+  const FrequencyRange m_frequencyRange;
+  const Block m_input;
+  Connector m_connector;
 };
\ No newline at end of file
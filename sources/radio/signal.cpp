@@ -3,33 +3,28 @@
 #include <config.h>
 #include <utils/utils.h>
 
-Signal::Signal(
-    const Config& config,
-    const Device& device,
-    const std::function<Frequency(const Index index)>& indexToFrequency,
-    const std::function<Frequency(const Index index)>& indexToShift,
-    const std::chrono::milliseconds& now)
-    : m_config(config), m_device(device), m_indexToFrequency(indexToFrequency), m_indexToShift(indexToShift), m_firstDataTime(now), m_lastDataTime(now), m_power(0.0) {}
+Signal::Signal(const std::function<Frequency(const Index index)>& indexToFrequency, const std::function<Frequency(const Index index)>& indexToShift, const std::chrono::milliseconds& now)
+    : m_indexToFrequency(indexToFrequency), m_indexToShift(indexToShift), m_firstDataTime(now), m_lastDataTime(now), m_power(0.0) {}
 
 Signal::~Signal() {}
 
-void Signal::newData(const Index avgIndex, const float avgPower, const Index, const float, const std::chrono::milliseconds& now) {
+void Signal::newData(const DetectionConfig& detection, const Index avgIndex, const float avgPower, const Index, const float, const std::chrono::milliseconds& now) {
   m_power = avgPower;
-  if (m_device.stop_recording_level <= avgPower) {
+  if (detection.stopLevel <= avgPower) {
     m_lastDataTime = now;
   }
-  if (m_device.start_recording_level <= avgPower) {
+  if (detection.startLevel <= avgPower) {
     m_indexes.push_back(avgIndex);
   }
 }
 
-bool Signal::isMinimalTime(const std::chrono::milliseconds& now) const { return m_firstDataTime + m_config.recordingMinTime() <= now; }
+bool Signal::isMinimalTime(const DetectionConfig& detection, const std::chrono::milliseconds& now) const { return m_firstDataTime + detection.minTime <= now; }
 
 bool Signal::isMaximalTime(const std::chrono::milliseconds& now) const { return m_firstDataTime + TRANSMISSION_MAX_TIME <= now; }
 
-bool Signal::isTimeout(const std::chrono::milliseconds& now) const { return m_lastDataTime + m_config.recordingTimeout() <= now; }
+bool Signal::isTimeout(const DetectionConfig& detection, const std::chrono::milliseconds& now) const { return m_lastDataTime + detection.timeout <= now; }
 
-bool Signal::needFlush(const std::chrono::milliseconds& now) const { return m_lastDataTime == now && isMinimalTime(now); }
+bool Signal::needFlush(const DetectionConfig& detection, const std::chrono::milliseconds& now) const { return m_lastDataTime == now && isMinimalTime(detection, now); }
 
 float Signal::getPower() const { return m_power; }
 
@@ -10,28 +10,22 @@ class Signal {
   using Index = int;
 
  public:
-  Signal(
-      const Config& config,
-      const Device& device,
-      const std::function<Frequency(const Index index)>& indexToFrequency,
-      const std::function<Frequency(const Index index)>& indexToShift,
-      const std::chrono::milliseconds& now);
+  Signal(const std::function<Frequency(const Index index)>& indexToFrequency, const std::function<Frequency(const Index index)>& indexToShift, const std::chrono::milliseconds& now);
   ~Signal();
 
-  void newData(const Index avgIndex, const float avgPower, const Index rawIndex, const float rawPower, const std::chrono::milliseconds& now);
+  // detection config is passed by caller, so live parameter changes apply to already detected signals
+  void newData(const DetectionConfig& detection, const Index avgIndex, const float avgPower, const Index rawIndex, const float rawPower, const std::chrono::milliseconds& now);
 
-  bool isMinimalTime(const std::chrono::milliseconds& now) const;
+  bool isMinimalTime(const DetectionConfig& detection, const std::chrono::milliseconds& now) const;
   bool isMaximalTime(const std::chrono::milliseconds& now) const;
-  bool isTimeout(const std::chrono::milliseconds& now) const;
-  bool needFlush(const std::chrono::milliseconds& now) const;
+  bool isTimeout(const DetectionConfig& detection, const std::chrono::milliseconds& now) const;
+  bool needFlush(const DetectionConfig& detection, const std::chrono::milliseconds& now) const;
   float getPower() const;
   Index getIndex() const;
   std::chrono::milliseconds getDuration() const;
   std::chrono::milliseconds getLastDataTime(const std::chrono::milliseconds& now) const;
 
  private:
-  const Config& m_config;
-  const Device& m_device;
   std::function<Frequency(const Index index)> m_indexToFrequency;
   std::function<Frequency(const Index index)> m_indexToShift;
   std::chrono::milliseconds m_firstDataTime;
@@ -0,0 +1,7 @@
+#include "spectrogram_lease.h"
+
+SpectrogramLease::SpectrogramLease(std::chrono::milliseconds duration) : m_duration(duration), m_expiration(std::chrono::milliseconds(0)) {}
+
+bool SpectrogramLease::renew(std::chrono::milliseconds now) { return m_expiration.exchange(now + m_duration) <= now; }
+
+bool SpectrogramLease::isActive(std::chrono::milliseconds now) const { return now < m_expiration.load(); }
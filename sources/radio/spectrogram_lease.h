@@ -0,0 +1,18 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+// spectrogram is processed only while clients keep renewing subscription, renewed from mqtt thread and read by processors
+class SpectrogramLease {
+ public:
+  SpectrogramLease(std::chrono::milliseconds duration);
+
+  // returns true when lease was expired before, new subscription
+  bool renew(std::chrono::milliseconds now);
+  bool isActive(std::chrono::milliseconds now) const;
+
+ private:
+  const std::chrono::milliseconds m_duration;
+  std::atomic<std::chrono::milliseconds> m_expiration;
+};
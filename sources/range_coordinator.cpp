@@ -0,0 +1,82 @@
+#include "range_coordinator.h"
+
+#include <logger.h>
+#include <utils/radio_utils.h>
+#include <utils/utils.h>
+
+#include <limits>
+
+constexpr auto LABEL = "coordinator";
+constexpr auto MIN_FREE_TIME = 0.1;        // device fully pinned by recordings still keeps part of pooled ranges
+constexpr auto REBALANCE_THRESHOLD = 0.2;  // reassign ranges only if device weight changed more than n
+
+RangeCoordinator::RangeCoordinator(const Config& config) : m_config(config), m_lastUpdateTime(0), m_isInvalid(true) {}
+
+void RangeCoordinator::update(std::map<std::string, std::unique_ptr<Scanner>>& scanners) {
+  const auto now = getTime();
+  if (!m_isInvalid && now < m_lastUpdateTime + RANGE_REBALANCE_INTERVAL) {
+    return;
+  }
+  m_lastUpdateTime = now;
+
+  const auto pooledRanges = m_config.pooledRanges();
+  std::vector<Device> devices;
+  std::map<std::string, double> weights;
+  for (const auto& device : m_config.devices()) {
+    const auto it = scanners.find(device.getName());
+    if (device.enabled && device.pooled && it != scanners.end() && !pooledRanges.empty()) {
+      const auto load = it->second->getLoad();
+      weights[device.getName()] = getRangeSplitSampleRate(device.sample_rate) * std::max(MIN_FREE_TIME, 1.0 - load);
+      devices.push_back(device);
+      Logger::debug(LABEL, "device: {}, recording load: {:.2f}", device.getName(), load);
+    } else if (m_assignment.count(device.getName())) {
+      if (it != scanners.end()) {
+        Logger::info(LABEL, "device left pool: {}", colored(GREEN, "{}", device.getName()));
+        it->second->updateRanges(device, false);
+      }
+      m_assignment.erase(device.getName());
+    }
+  }
+  const auto isForced = m_isInvalid;
+  m_isInvalid = false;
+  if (devices.empty() || (!isForced && isBalanced(weights))) {
+    return;
+  }
+  m_weights = weights;
+
+  std::vector<double> deviceWeights;
+  Frequency step = std::numeric_limits<Frequency>::max();
+  for (const auto& device : devices) {
+    deviceWeights.push_back(weights[device.getName()]);
+    step = std::min(step, getRangeSplitSampleRate(device.sample_rate));
+  }
+  const auto assignment = assignRanges(pooledRanges, deviceWeights, step);
+  for (size_t i = 0; i < devices.size(); ++i) {
+    auto device = devices[i];
+    if (!isForced && m_assignment.count(device.getName()) && m_assignment[device.getName()] == assignment[i]) {
+      continue;
+    }
+    Logger::info(LABEL, "device: {}, pooled ranges: {}", colored(GREEN, "{}", device.getName()), colored(GREEN, "{}", assignment[i].size()));
+    for (const auto& range : assignment[i]) {
+      Logger::info(LABEL, "device: {}, pooled range: {}", colored(GREEN, "{}", device.getName()), formatFrequencyRange(range));
+    }
+    m_assignment[device.getName()] = assignment[i];
+    device.ranges.insert(device.ranges.end(), assignment[i].begin(), assignment[i].end());
+    scanners.at(device.getName())->updateRanges(device, false);
+  }
+}
+
+void RangeCoordinator::invalidate() { m_isInvalid = true; }
+
+bool RangeCoordinator::isBalanced(const std::map<std::string, double>& weights) const {
+  if (weights.size() != m_weights.size()) {
+    return false;
+  }
+  for (const auto& [name, weight] : weights) {
+    const auto it = m_weights.find(name);
+    if (it == m_weights.end() || REBALANCE_THRESHOLD * it->second < std::abs(weight - it->second)) {
+      return false;
+    }
+  }
+  return true;
+}
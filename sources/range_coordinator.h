@@ -0,0 +1,31 @@
+#pragma once
+
+#include <config.h>
+#include <scanner.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// assigns pooled ranges to devices with pooled flag, share is proportional to device split sample rate
+// and time not spent on recordings, so busy devices offload ranges to idle ones
+class RangeCoordinator {
+ public:
+  explicit RangeCoordinator(const Config& config);
+
+  // call periodically from thread owning scanners
+  void update(std::map<std::string, std::unique_ptr<Scanner>>& scanners);
+  // forces new assignment at next update, e.g. after config change
+  void invalidate();
+
+ private:
+  bool isBalanced(const std::map<std::string, double>& weights) const;
+
+  const Config& m_config;
+  std::chrono::milliseconds m_lastUpdateTime;
+  bool m_isInvalid;
+  std::map<std::string, double> m_weights;
+  std::map<std::string, std::vector<FrequencyRange>> m_assignment;
+};
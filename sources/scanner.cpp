@@ -2,16 +2,29 @@
 
 #include <config.h>
 #include <logger.h>
+#include <tracer.h>
+#include <utils/thread_utils.h>
 
 constexpr auto LABEL = "scanner";
-constexpr auto LOOP_TIMEOUT = std::chrono::milliseconds(10);
 
 Scanner::Scanner(const Config& config, const Device& device, RemoteController& remoteController)
-    : m_ranges(splitRanges(device.ranges, getRangeSplitSampleRate(device.sample_rate))),
-      m_device(config, device, remoteController, m_notification, m_ranges),
+    : m_config(config),
+      m_interest(subtractRanges(device.ranges, config.ignoredRanges())),
+      m_ranges(planRanges(m_interest, getRangeSplitSampleRate(device.sample_rate), RANGE_DC_GUARD)),
+      m_device(config, device, remoteController, m_notification, m_ranges, m_interest),
       m_scheduler(config, device, remoteController),
+      m_pendingRebuild(false),
+      m_lastLoadTime(getTime()),
+      m_recordingTime(0),
+      m_totalTime(0),
       m_isRunning(true),
-      m_thread([this]() { worker(); }) {
+      m_thread([this, device]() {
+        setThreadName("scan_" + device.serial);
+        if (!setThreadAffinity(device.cores)) {
+          Logger::warn(LABEL, "set thread affinity failed, device: {}", device.getName());
+        }
+        worker();
+      }) {
   Logger::info(LABEL, "starting");
   Logger::info(LABEL, "ignored ranges: {}", colored(GREEN, "{}", config.ignoredRanges().size()));
   for (const auto& range : config.ignoredRanges()) {
@@ -22,9 +35,9 @@ Scanner::Scanner(const Config& config, const Device& device, RemoteController& r
     Logger::info(LABEL, "scan range: {}", formatFrequencyRange(range));
   }
   Logger::info(LABEL, "sample rate: {}, split sample rate: {}", formatFrequency(device.sample_rate), formatFrequency(getRangeSplitSampleRate(device.sample_rate)));
-  Logger::info(LABEL, "splitted scan ranges: {}", colored(GREEN, "{}", m_ranges.size()));
+  Logger::info(LABEL, "planned scan ranges: {}", colored(GREEN, "{}", m_ranges.size()));
   for (const auto& range : m_ranges) {
-    Logger::info(LABEL, "splitted scan range: {}", formatFrequencyRange(range));
+    Logger::info(LABEL, "planned scan range: {}, center: {}", formatFrequencyRange(range), formatFrequency(range.center()));
   }
   Logger::info(LABEL, "started");
 }
@@ -35,22 +48,82 @@ Scanner::~Scanner() {
   m_thread.join();
 }
 
+void Scanner::updateRanges(const Device& device, bool rebuild) {
+  std::unique_lock lock(m_mutex);
+  m_pendingInterest = subtractRanges(device.ranges, m_config.ignoredRanges());
+  m_pendingRanges = planRanges(*m_pendingInterest, getRangeSplitSampleRate(device.sample_rate), RANGE_DC_GUARD);
+  m_pendingRebuild = m_pendingRebuild || rebuild;
+}
+
+void Scanner::updateSchedule(const Device& device) { m_scheduler.update(device); }
+
+double Scanner::getLoad() {
+  const auto recordingTime = m_recordingTime.exchange(0);
+  const auto totalTime = m_totalTime.exchange(0);
+  return 0 < totalTime ? static_cast<double>(recordingTime) / totalTime : 0.0;
+}
+
+void Scanner::updateLoad(bool isRecording) {
+  const auto now = getTime();
+  const auto duration = (now - m_lastLoadTime).count();
+  m_lastLoadTime = now;
+  m_totalTime += duration;
+  if (isRecording) {
+    m_recordingTime += duration;
+  }
+}
+
+bool Scanner::applyPendingRanges() {
+  std::unique_lock lock(m_mutex);
+  if (!m_pendingRanges) {
+    return false;
+  }
+  m_interest = std::move(*m_pendingInterest);
+  m_ranges = std::move(*m_pendingRanges);
+  m_pendingInterest.reset();
+  m_pendingRanges.reset();
+  const auto rebuild = m_pendingRebuild;
+  m_pendingRebuild = false;
+  lock.unlock();
+
+  Logger::info(LABEL, "update planned scan ranges: {}", colored(GREEN, "{}", m_ranges.size()));
+  for (const auto& range : m_ranges) {
+    Logger::info(LABEL, "planned scan range: {}, center: {}", formatFrequencyRange(range), formatFrequency(range.center()));
+  }
+  m_device.updateRanges(m_ranges, m_interest, rebuild);
+  return true;
+}
+
 void Scanner::runScheduler(const std::optional<FrequencyRange>& activeRange) {
-  auto recordings = m_scheduler.getRecordings(getTime());
+  if (getTime() < m_scheduler.getNextEventTime()) {
+    return;
+  }
+  auto recordings = m_scheduler.getRecordings(getTime(), m_ranges);
   if (recordings) {
     Logger::info(LABEL, "start scheduled recording");
+    Tracer::Scope scope("scheduled recording");
     m_scheduler.setRefreshEnabled(false);
     auto lastRange = FrequencyRange(0, 0);
     while (m_isRunning && recordings) {
       const auto range = recordings->first;
+      const auto isScanning = std::find(m_ranges.begin(), m_ranges.end(), range) != m_ranges.end();
       if (range != lastRange) {
-        Logger::info(LABEL, "update scheduled frequency, center: {}", formatFrequency(range.center()));
+        Logger::info(LABEL, "update scheduled frequency, center: {}, scanning: {}", formatFrequency(range.center()), colored(GREEN, "{}", isScanning));
         m_device.setFrequencyRange(range);
         lastRange = range;
       }
-      m_device.updateRecordings(recordings->second);
-      recordings = m_scheduler.getRecordings(getTime());
-      std::this_thread::sleep_for(LOOP_TIMEOUT);
+      if (isScanning) {
+        // detected transmissions share recorders limit, scheduled ones are started first
+        auto active = std::move(recordings->second);
+        const auto notification = m_notification.wait();
+        updateLoad(!notification.empty());
+        active.insert(active.end(), notification.begin(), notification.end());
+        m_device.updateRecordings(active);
+      } else {
+        m_device.updateRecordings(recordings->second);
+        m_scheduler.wait(RECORDER_FLUSH_INTERVAL);
+      }
+      recordings = m_scheduler.getRecordings(getTime(), m_ranges);
     }
     m_device.updateRecordings({});
     if (activeRange) {
@@ -63,33 +136,39 @@ void Scanner::runScheduler(const std::optional<FrequencyRange>& activeRange) {
 
 void Scanner::worker() {
   Logger::info(LABEL, "thread started");
-  if (m_ranges.empty()) {
-    Logger::warn(LABEL, "empty scanned ranges");
-    while (m_isRunning) {
-      runScheduler(std::nullopt);
-      std::this_thread::sleep_for(LOOP_TIMEOUT);
-    }
-  } else if (m_ranges.size() == 1) {
-    m_device.setFrequencyRange(m_ranges.front());
-    while (m_isRunning) {
-      runScheduler(m_ranges.front());
-      m_device.updateRecordings(m_notification.wait());
-    }
-  } else {
-    while (m_isRunning) {
-      for (const auto& range : m_ranges) {
-        m_device.setFrequencyRange(range);
+  while (m_isRunning) {
+    if (m_ranges.empty()) {
+      Logger::warn(LABEL, "empty scanned ranges");
+      while (m_isRunning && !applyPendingRanges()) {
+        runScheduler(std::nullopt);
+        m_scheduler.wait(RANGE_SCANNING_TIME);
+        updateLoad(false);
+      }
+    } else if (m_ranges.size() == 1) {
+      m_device.setFrequencyRange(m_ranges.front());
+      while (m_isRunning && !applyPendingRanges()) {
+        runScheduler(m_ranges.front());
+        const auto notification = m_notification.wait();
+        updateLoad(!notification.empty());
+        m_device.updateRecordings(notification);
+      }
+    } else {
+      while (m_isRunning && !applyPendingRanges()) {
+        for (const auto& range : m_ranges) {
+          m_device.setFrequencyRange(range);
 
-        const auto startScanningTime = getTime();
-        bool isRecording = true;
-        while ((getTime() <= startScanningTime + RANGE_SCANNING_TIME || isRecording) && m_isRunning) {
-          runScheduler(range);
-          const auto notification = m_notification.wait();
-          isRecording = !notification.empty();
-          m_device.updateRecordings(notification);
-        }
-        if (!m_isRunning) {
-          break;
+          const auto startScanningTime = getTime();
+          bool isRecording = true;
+          while ((getTime() <= startScanningTime + RANGE_SCANNING_TIME || isRecording) && m_isRunning) {
+            runScheduler(range);
+            const auto notification = m_notification.wait();
+            isRecording = !notification.empty();
+            updateLoad(isRecording);
+            m_device.updateRecordings(notification);
+          }
+          if (!m_isRunning) {
+            break;
+          }
         }
       }
     }
@@ -8,7 +8,10 @@
 #include <radio/sdr_device.h>
 
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <thread>
 
 class Scanner {
@@ -16,14 +19,32 @@ class Scanner {
   Scanner(const Config& config, const Device& device, RemoteController& remoteController);
   ~Scanner();
 
+  // applied by worker thread before next range, rebuild forces all processors
+  void updateRanges(const Device& device, bool rebuild);
+  void updateSchedule(const Device& device);
+  // fraction of time spent on recordings since last call
+  double getLoad();
+
  private:
   void runScheduler(const std::optional<FrequencyRange>& activeRange);
+  bool applyPendingRanges();
+  void updateLoad(bool isRecording);
   void worker();
 
-  const std::vector<FrequencyRange> m_ranges;
+  const Config& m_config;
+  std::vector<FrequencyRange> m_interest;
+  std::vector<FrequencyRange> m_ranges;
   SdrDevice m_device;
   Scheduler m_scheduler;
 
+  std::mutex m_mutex;
+  std::optional<std::vector<FrequencyRange>> m_pendingInterest;
+  std::optional<std::vector<FrequencyRange>> m_pendingRanges;
+  bool m_pendingRebuild;
+  std::chrono::milliseconds m_lastLoadTime;
+  std::atomic<int64_t> m_recordingTime;
+  std::atomic<int64_t> m_totalTime;
+
   std::atomic<bool> m_isRunning;
   std::thread m_thread;
   TransmissionNotification m_notification;
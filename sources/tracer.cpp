@@ -0,0 +1,152 @@
+#include "tracer.h"
+
+#include <logger.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+constexpr auto LABEL = "tracer";
+constexpr auto EVENTS_PER_THREAD = 16384;  // ring buffer size, oldest events are overwritten
+constexpr auto MAX_EXITED_THREADS = 16;    // buffers of exited threads kept for dump, oldest are dropped
+
+namespace {
+struct Event {
+  const char* name;
+  const char* argName;
+  int64_t argValue;
+  uint64_t id;
+  int64_t timestamp;
+  int64_t duration;
+  char phase;
+};
+
+struct ThreadBuffer {
+  std::mutex mutex;
+  std::vector<Event> events;
+  size_t next = 0;
+  size_t count = 0;
+  int tid = 0;
+  std::string name;
+};
+
+std::atomic<bool> isTracerEnabled{false};
+std::mutex buffersMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+int nextTid = 1;
+
+int64_t now() { return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+// requires buffersMutex, buffer owned only by registry belongs to exited thread
+void dropExitedBuffers() {
+  const auto isExited = [](const std::shared_ptr<ThreadBuffer>& buffer) { return buffer.use_count() == 1; };
+  auto exited = std::count_if(buffers.begin(), buffers.end(), isExited);
+  for (auto it = buffers.begin(); it != buffers.end() && MAX_EXITED_THREADS < exited;) {
+    if (isExited(*it)) {
+      it = buffers.erase(it);
+      --exited;
+    } else {
+      ++it;
+    }
+  }
+}
+
+ThreadBuffer& threadBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<ThreadBuffer>();
+    buffer->events.resize(EVENTS_PER_THREAD);
+    char name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    buffer->name = name;
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    dropExitedBuffers();
+    buffer->tid = nextTid++;
+    buffers.push_back(buffer);
+  }
+  return *buffer;
+}
+
+void push(const Event& event) {
+  auto& buffer = threadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.events[buffer.next] = event;
+  buffer.next = (buffer.next + 1) % buffer.events.size();
+  buffer.count = std::min(buffer.count + 1, buffer.events.size());
+}
+}  // namespace
+
+Tracer::Scope::Scope(const char* name, const char* argName, int64_t argValue) : m_name(name), m_argName(argName), m_argValue(argValue), m_start(isEnabled() ? now() : 0) {}
+
+Tracer::Scope::~Scope() {
+  if (m_start && isEnabled()) {
+    push({m_name, m_argName, m_argValue, 0, m_start, now() - m_start, 'X'});
+  }
+}
+
+void Tracer::setEnabled(bool enabled) {
+  isTracerEnabled = enabled;
+  Logger::info(LABEL, "enabled: {}", colored(GREEN, "{}", enabled));
+}
+
+bool Tracer::isEnabled() { return isTracerEnabled.load(std::memory_order_relaxed); }
+
+void Tracer::instant(const char* name, const char* argName, int64_t argValue) {
+  if (isEnabled()) {
+    push({name, argName, argValue, 0, now(), 0, 'i'});
+  }
+}
+
+void Tracer::asyncBegin(const char* name, uint64_t id) {
+  if (isEnabled()) {
+    push({name, nullptr, 0, id, now(), 0, 'b'});
+  }
+}
+
+void Tracer::asyncEnd(const char* name, uint64_t id) {
+  if (isEnabled()) {
+    push({name, nullptr, 0, id, now(), 0, 'e'});
+  }
+}
+
+void Tracer::dump(const std::string& path) {
+  auto events = nlohmann::json::array();
+  std::vector<std::shared_ptr<ThreadBuffer>> tmp;
+  {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    tmp = buffers;
+  }
+  for (const auto& buffer : tmp) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", buffer->tid}, {"args", {{"name", buffer->name}}}});
+    const auto size = buffer->events.size();
+    for (size_t i = 0; i < buffer->count; ++i) {
+      const auto& event = buffer->events[(buffer->next + size - buffer->count + i) % size];
+      nlohmann::json json = {{"name", event.name}, {"cat", "sdr"}, {"ph", std::string(1, event.phase)}, {"ts", event.timestamp}, {"pid", 1}, {"tid", buffer->tid}};
+      if (event.phase == 'X') {
+        json["dur"] = event.duration;
+      } else if (event.phase == 'i') {
+        json["s"] = "t";
+      } else {
+        json["id"] = event.id;
+      }
+      if (event.argName) {
+        json["args"] = {{event.argName, event.argValue}};
+      }
+      events.push_back(json);
+    }
+  }
+
+  std::ofstream stream(path);
+  if (!stream) {
+    Logger::warn(LABEL, "dump failed, can not open: {}", path);
+    return;
+  }
+  stream << nlohmann::json({{"traceEvents", events}, {"displayTimeUnit", "ms"}}).dump();
+  Logger::info(LABEL, "dumped: {}, events: {}", colored(GREEN, "{}", path), events.size());
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// optional event tracer, events are kept in per thread ring buffers and dumped as chrome trace event json
+// (chrome://tracing, ui.perfetto.dev), event names must be string literals, disabled tracer costs single atomic load
+class Tracer {
+ private:
+  Tracer() = delete;
+  ~Tracer() = delete;
+
+ public:
+  // complete event covering scope lifetime
+  class Scope {
+   public:
+    explicit Scope(const char* name, const char* argName = nullptr, int64_t argValue = 0);
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope();
+
+   private:
+    const char* m_name;
+    const char* m_argName;
+    const int64_t m_argValue;
+    const int64_t m_start;
+  };
+
+  static void setEnabled(bool enabled);
+  static bool isEnabled();
+
+  static void instant(const char* name, const char* argName = nullptr, int64_t argValue = 0);
+  // events spanning threads or work calls, matched by name and id
+  static void asyncBegin(const char* name, uint64_t id);
+  static void asyncEnd(const char* name, uint64_t id);
+
+  static void dump(const std::string& path);
+};
@@ -0,0 +1,138 @@
+#include "cron_expression.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+constexpr auto SEARCH_LIMIT = std::chrono::years(5);  // impossible expressions like 30 february stop here
+constexpr std::array MONTH_NAMES = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+constexpr std::array WEEKDAY_NAMES = {"SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT"};
+
+namespace {
+
+std::vector<std::string> split(const std::string& value, const char delimiter) {
+  std::vector<std::string> parts;
+  std::stringstream stream(value);
+  std::string part;
+  while (std::getline(stream, part, delimiter)) {
+    parts.push_back(part);
+  }
+  return parts;
+}
+
+int parseValue(std::string value, const int offset, const char* const* names, const size_t namesSize) {
+  std::transform(value.begin(), value.end(), value.begin(), ::toupper);
+  for (size_t i = 0; i < namesSize; ++i) {
+    if (value == names[i]) {
+      return offset + i;
+    }
+  }
+  if (value.empty() || !std::all_of(value.begin(), value.end(), ::isdigit)) {
+    throw std::runtime_error(fmt::format("invalid cron value: {}", value));
+  }
+  return std::stoi(value);
+}
+
+template <size_t N>
+bool parseField(const std::string& field, std::bitset<N>& bits, const int min, const int max, const char* const* names = nullptr, const size_t namesSize = 0) {
+  for (const auto& part : split(field, ',')) {
+    const auto slash = part.find('/');
+    const auto range = part.substr(0, slash);
+    const auto step = slash == std::string::npos ? 1 : parseValue(part.substr(slash + 1), 0, nullptr, 0);
+    int first = min;
+    int last = max;
+    if (range != "*") {
+      const auto dash = range.find('-');
+      first = parseValue(range.substr(0, dash), min, names, namesSize);
+      last = dash != std::string::npos ? parseValue(range.substr(dash + 1), min, names, namesSize) : (slash != std::string::npos ? max : first);
+    }
+    // sunday can be written as 7
+    if (N == 7 && last == 7) {
+      bits.set(0);
+      last = 6;
+    }
+    if (step <= 0 || first < min || max < last || (last < first && !(N == 7 && first == 7))) {
+      throw std::runtime_error(fmt::format("invalid cron field: {}", field));
+    }
+    for (int value = first; value <= last; value += step) {
+      bits.set(value);
+    }
+  }
+  return field.front() != '*';
+}
+
+}  // namespace
+
+CronExpression::CronExpression(const std::string& expression) {
+  std::vector<std::string> fields;
+  std::stringstream stream(expression);
+  std::string field;
+  while (stream >> field) {
+    fields.push_back(field);
+  }
+  if (fields.size() == 5) {
+    fields.insert(fields.begin(), "0");
+  }
+  if (fields.size() != 6) {
+    throw std::runtime_error(fmt::format("invalid cron expression: {}", expression));
+  }
+  for (auto* value : {&fields[3], &fields[5]}) {
+    if (*value == "?") {
+      *value = "*";
+    }
+  }
+  parseField(fields[0], m_seconds, 0, 59);
+  parseField(fields[1], m_minutes, 0, 59);
+  parseField(fields[2], m_hours, 0, 23);
+  m_isDayRestricted = parseField(fields[3], m_days, 1, 31);
+  parseField(fields[4], m_months, 1, 12, MONTH_NAMES.data(), MONTH_NAMES.size());
+  m_isWeekdayRestricted = parseField(fields[5], m_weekdays, 0, 6, WEEKDAY_NAMES.data(), WEEKDAY_NAMES.size());
+}
+
+bool CronExpression::isDayMatched(const std::chrono::sys_days& day) const {
+  const std::chrono::year_month_day date(day);
+  const auto isDay = m_days.test(static_cast<unsigned>(date.day()));
+  const auto isWeekday = m_weekdays.test(std::chrono::weekday(day).c_encoding());
+  if (m_isDayRestricted && m_isWeekdayRestricted) {
+    return isDay || isWeekday;
+  }
+  return isDay && isWeekday;
+}
+
+std::optional<std::chrono::seconds> CronExpression::next(const std::chrono::seconds& after) const {
+  using namespace std::chrono;
+  const sys_seconds limit(after + duration_cast<seconds>(SEARCH_LIMIT));
+  sys_seconds time(after + seconds(1));
+  while (time <= limit) {
+    const auto day = floor<days>(time);
+    const year_month_day date(day);
+    if (!m_months.test(static_cast<unsigned>(date.month()))) {
+      const auto month = year_month(date.year(), date.month()) + months(1);
+      time = sys_days(month / 1);
+      continue;
+    }
+    if (!isDayMatched(day)) {
+      time = day + days(1);
+      continue;
+    }
+    const hh_mm_ss clock(time - day);
+    if (!m_hours.test(clock.hours().count())) {
+      time = day + clock.hours() + hours(1);
+      continue;
+    }
+    if (!m_minutes.test(clock.minutes().count())) {
+      time = day + clock.hours() + clock.minutes() + minutes(1);
+      continue;
+    }
+    if (!m_seconds.test(clock.seconds().count())) {
+      time += seconds(1);
+      continue;
+    }
+    return time.time_since_epoch();
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <bitset>
+#include <chrono>
+#include <optional>
+#include <string>
+
+// cron expression evaluated in UTC, 5 fields (minute hour day month weekday) or 6 fields with leading seconds
+// fields support *, lists, ranges, steps and month or weekday names, day and weekday match either when both are set
+class CronExpression {
+ public:
+  explicit CronExpression(const std::string& expression);
+
+  // first matching time after given time, nullopt if none in next years
+  std::optional<std::chrono::seconds> next(const std::chrono::seconds& after) const;
+
+ private:
+  bool isDayMatched(const std::chrono::sys_days& day) const;
+
+  std::bitset<60> m_seconds;
+  std::bitset<60> m_minutes;
+  std::bitset<24> m_hours;
+  std::bitset<32> m_days;
+  std::bitset<13> m_months;
+  std::bitset<7> m_weekdays;
+  bool m_isDayRestricted;
+  bool m_isWeekdayRestricted;
+};
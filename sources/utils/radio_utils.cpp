@@ -3,8 +3,11 @@
 #include <logger.h>
 #include <utils/utils.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <limits>
 #include <numeric>
+#include <optional>
 
 namespace {
 void split(const int value, std::vector<int>& factors, const int threshold) {
@@ -33,6 +36,30 @@ void split(const int value, std::vector<int>& factors, const int threshold) {
     factors.push_back(value);
   }
 }
+
+// center in [lo, hi] nearest to preferred, at least guard away from ranges, preferred if none
+Frequency getSafeCenter(const std::vector<FrequencyRange>& ranges, Frequency lo, Frequency hi, Frequency preferred, Frequency guard) {
+  std::vector<FrequencyRange> gaps;
+  gaps.emplace_back(std::numeric_limits<Frequency>::min() / 2, ranges.front().start - guard);
+  for (size_t i = 1; i < ranges.size(); ++i) {
+    gaps.emplace_back(ranges[i - 1].stop + guard, ranges[i].start - guard);
+  }
+  gaps.emplace_back(ranges.back().stop + guard, std::numeric_limits<Frequency>::max() / 2);
+
+  std::optional<Frequency> best;
+  for (const auto& gap : gaps) {
+    const auto start = std::max(gap.start, lo);
+    const auto stop = std::min(gap.stop, hi);
+    if (stop < start) {
+      continue;
+    }
+    const auto center = std::clamp(preferred, start, stop);
+    if (!best || std::abs(center - preferred) < std::abs(*best - preferred)) {
+      best = center;
+    }
+  }
+  return best.value_or(preferred);
+}
 }  // namespace
 
 std::string formatFrequency(const Frequency frequency, const char* color) {
@@ -188,24 +215,100 @@ Frequency getRangeSplitSampleRate(Frequency sampleRate) {
   }
 }
 
-std::vector<FrequencyRange> splitRange(const FrequencyRange& range, Frequency sampleRate) {
-  if (range.bandwidth() <= sampleRate) {
-    return {range};
-  } else {
-    std::vector<FrequencyRange> ranges;
-    for (Frequency f = range.start; f < range.stop; f += sampleRate) {
-      ranges.emplace_back(f, f + sampleRate);
+std::vector<FrequencyRange> subtractRanges(std::vector<FrequencyRange> ranges, const std::vector<FrequencyRange>& ignored) {
+  std::sort(ranges.begin(), ranges.end(), [](const FrequencyRange& r1, const FrequencyRange& r2) { return r1.start < r2.start; });
+  std::vector<FrequencyRange> merged;
+  for (const auto& range : ranges) {
+    if (!merged.empty() && range.start <= merged.back().stop) {
+      merged.back().stop = std::max(merged.back().stop, range.stop);
+    } else if (range.start < range.stop) {
+      merged.push_back(range);
     }
-    return ranges;
   }
+  std::vector<FrequencyRange> results;
+  for (const auto& range : merged) {
+    std::vector<FrequencyRange> parts{range};
+    for (const auto& ignoredRange : ignored) {
+      std::vector<FrequencyRange> remaining;
+      for (const auto& part : parts) {
+        if (ignoredRange.stop <= part.start || part.stop <= ignoredRange.start) {
+          remaining.push_back(part);
+          continue;
+        }
+        if (part.start < ignoredRange.start) {
+          remaining.emplace_back(part.start, ignoredRange.start);
+        }
+        if (ignoredRange.stop < part.stop) {
+          remaining.emplace_back(ignoredRange.stop, part.stop);
+        }
+      }
+      parts = std::move(remaining);
+    }
+    results.insert(results.end(), parts.begin(), parts.end());
+  }
+  return results;
 }
 
-std::vector<FrequencyRange> splitRanges(const std::vector<FrequencyRange>& ranges, Frequency sampleRate) {
+std::vector<FrequencyRange> planRanges(const std::vector<FrequencyRange>& ranges, Frequency bandwidth, Frequency dcGuard) {
+  const auto merged = subtractRanges(ranges, {});
   std::vector<FrequencyRange> results;
+  size_t index = 0;
+  Frequency position = merged.empty() ? 0 : merged.front().start;
+  while (index < merged.size()) {
+    // greedy packing from lowest uncovered frequency gives fewest tunings, ranges wider than bandwidth are split
+    const auto start = std::max(position, merged[index].start);
+    const auto limit = start + bandwidth;
+    std::vector<FrequencyRange> group;
+    while (index < merged.size() && merged[index].start < limit) {
+      group.emplace_back(std::max(start, merged[index].start), std::min(limit, merged[index].stop));
+      if (merged[index].stop <= limit) {
+        index++;
+      } else {
+        break;
+      }
+    }
+    position = limit;
+
+    // slack of narrower groups moves dc out of ranges
+    const auto stop = group.back().stop;
+    const auto center = getSafeCenter(group, stop - bandwidth / 2, start + bandwidth / 2, start + (stop - start) / 2, dcGuard);
+    const auto halfWidth = std::max(center - start, stop - center);
+    results.emplace_back(center - halfWidth, center + halfWidth);
+  }
+  return results;
+}
+
+std::vector<std::vector<FrequencyRange>> assignRanges(std::vector<FrequencyRange> ranges, const std::vector<double>& weights, Frequency step) {
+  std::vector<std::vector<FrequencyRange>> results(weights.size());
+  const auto sumWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
+  if (ranges.empty() || sumWeights <= 0.0) {
+    return results;
+  }
+  std::sort(ranges.begin(), ranges.end(), [](const FrequencyRange& r1, const FrequencyRange& r2) { return r1.start < r2.start; });
+  const auto total = std::accumulate(ranges.begin(), ranges.end(), int64_t{0}, [](int64_t sum, const FrequencyRange& range) { return sum + range.bandwidth(); });
+
+  std::vector<int64_t> limits;
+  double cumulativeWeight = 0.0;
+  for (const auto& weight : weights) {
+    cumulativeWeight += weight;
+    const auto limit = static_cast<int64_t>(std::llround(total * cumulativeWeight / sumWeights / std::max(1, step))) * std::max(1, step);
+    limits.push_back(std::min(total, limit));
+  }
+  limits.back() = total;
+
+  size_t index = 0;
+  int64_t position = 0;
   for (const auto& range : ranges) {
-    for (const auto& _range : splitRange(range, sampleRate)) {
-      results.push_back(_range);
+    Frequency start = range.start;
+    while (start < range.stop) {
+      while (limits[index] <= position) {
+        index++;
+      }
+      const auto stop = static_cast<Frequency>(std::min<int64_t>(range.stop, start + limits[index] - position));
+      results[index].emplace_back(start, stop);
+      position += stop - start;
+      start = stop;
     }
   }
   return results;
-}
\ No newline at end of file
+}
@@ -24,6 +24,10 @@ int getDecimatorFactor(Frequency oldStep, Frequency newStep);
 
 Frequency getRangeSplitSampleRate(Frequency sampleRate);
 
-std::vector<FrequencyRange> splitRange(const FrequencyRange& range, Frequency sampleRate);
-
-std::vector<FrequencyRange> splitRanges(const std::vector<FrequencyRange>& ranges, Frequency sampleRate);
\ No newline at end of file
+// sorted and merged ranges with ignored parts removed
+std::vector<FrequencyRange> subtractRanges(std::vector<FrequencyRange> ranges, const std::vector<FrequencyRange>& ignored);
+// packs ranges into fewest tunings of given bandwidth, returned range center is tuned frequency
+// center is moved at least dcGuard away from ranges when tuning has enough slack
+std::vector<FrequencyRange> planRanges(const std::vector<FrequencyRange>& ranges, Frequency bandwidth, Frequency dcGuard);
+// splits pooled ranges into contiguous parts proportional to weights, part boundaries are rounded to step
+std::vector<std::vector<FrequencyRange>> assignRanges(std::vector<FrequencyRange> ranges, const std::vector<double>& weights, Frequency step);
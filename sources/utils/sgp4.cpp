@@ -0,0 +1,328 @@
+#include "sgp4.h"
+
+#include <fmt/format.h>
+#include <logger.h>
+
+#include <cmath>
+#include <numbers>
+#include <sstream>
+#include <stdexcept>
+
+constexpr auto LABEL = "sgp4";
+constexpr auto XKMPER = 6378.135;                    // wgs72 earth radius km
+constexpr auto XKE = 0.0743669161;                   // sqrt(gm) in earth radii^1.5 per minute
+constexpr auto CK2 = 0.5 * 0.001082616;              // 0.5 * j2
+constexpr auto CK4 = -0.375 * -0.00000165597;        // -0.375 * j4
+constexpr auto A3OVK2 = 0.00000253881 / CK2;         // -j3 / ck2
+constexpr auto S0 = 1.0 + 78.0 / XKMPER;             // atmosphere density parameter
+constexpr auto QOMS2T = 1.880279159015270643865e-9;  // ((120 - 78) / xkmper)^4
+constexpr auto TWO_THIRDS = 2.0 / 3.0;
+constexpr auto DEEP_SPACE_PERIOD = 225.0;  // minutes
+constexpr auto KEPLER_ITERATIONS = 10;
+constexpr auto WGS84_A = 6378.137;  // observer ellipsoid km
+constexpr auto WGS84_F = 1.0 / 298.257223563;
+constexpr auto DEG_TO_RAD = std::numbers::pi / 180.0;
+constexpr auto TWO_PI = 2.0 * std::numbers::pi;
+constexpr auto MINUTES_PER_DAY = 1440.0;
+constexpr auto RANGE_RATE_STEP = std::chrono::milliseconds(1000);
+
+namespace {
+
+double parseDouble(const std::string& line, size_t begin, size_t size) {
+  const auto value = line.substr(begin, size);
+  return std::stod(value);
+}
+
+// tle exponent notation, " 66816-4" is 0.66816e-4
+double parseExponent(const std::string& line, size_t begin, size_t size) {
+  auto value = line.substr(begin, size);
+  value.erase(0, value.find_first_not_of(' '));
+  if (value.empty()) {
+    return 0.0;
+  }
+  const auto sign = value.front() == '-' ? -1.0 : 1.0;
+  if (value.front() == '-' || value.front() == '+') {
+    value.erase(0, 1);
+  }
+  const auto exponent = value.find_last_of("+-");
+  if (exponent == std::string::npos || exponent == 0) {
+    return sign * std::stod("0." + value);
+  }
+  return sign * std::stod("0." + value.substr(0, exponent)) * std::pow(10.0, std::stoi(value.substr(exponent)));
+}
+
+std::string trim(const std::string& value) {
+  const auto begin = value.find_first_not_of(" \t\r");
+  const auto end = value.find_last_not_of(" \t\r");
+  return begin == std::string::npos ? "" : value.substr(begin, end - begin + 1);
+}
+
+double getGmst(const std::chrono::milliseconds& time) {
+  const auto julianDate = time.count() / 86400000.0 + 2440587.5;
+  const auto t = (julianDate - 2451545.0) / 36525.0;
+  const auto seconds = -6.2e-6 * t * t * t + 0.093104 * t * t + (876600.0 * 3600.0 + 8640184.812866) * t + 67310.54841;
+  const auto gmst = std::fmod(seconds * DEG_TO_RAD / 240.0, TWO_PI);
+  return gmst < 0.0 ? gmst + TWO_PI : gmst;
+}
+
+}  // namespace
+
+Tle Tle::parse(const std::string& name, const std::string& line1, const std::string& line2) {
+  if (line1.size() < 62 || line2.size() < 63 || line1[0] != '1' || line2[0] != '2') {
+    throw std::runtime_error(fmt::format("invalid tle: {}", name));
+  }
+  Tle tle;
+  tle.id = std::stoi(line1.substr(2, 5));
+  tle.name = trim(name);
+
+  const auto epochYear = std::stoi(line1.substr(18, 2));
+  const auto epochDay = parseDouble(line1, 20, 12);
+  const auto year = std::chrono::year(epochYear < 57 ? 2000 + epochYear : 1900 + epochYear);
+  const auto yearBegin = std::chrono::sys_days(year / std::chrono::January / 1).time_since_epoch();
+  tle.epoch = std::chrono::duration_cast<std::chrono::milliseconds>(yearBegin) + std::chrono::milliseconds(std::llround((epochDay - 1.0) * 86400000.0));
+  tle.bstar = parseExponent(line1, 53, 8);
+
+  tle.inclination = parseDouble(line2, 8, 8) * DEG_TO_RAD;
+  tle.raan = parseDouble(line2, 17, 8) * DEG_TO_RAD;
+  tle.eccentricity = std::stod("0." + line2.substr(26, 7));
+  tle.argumentOfPerigee = parseDouble(line2, 34, 8) * DEG_TO_RAD;
+  tle.meanAnomaly = parseDouble(line2, 43, 8) * DEG_TO_RAD;
+  tle.meanMotion = parseDouble(line2, 52, 11) * TWO_PI / MINUTES_PER_DAY;
+  return tle;
+}
+
+std::map<int, Tle> Tle::parseFile(const std::string& content) {
+  std::map<int, Tle> tles;
+  std::stringstream stream(content);
+  std::string line;
+  std::string name;
+  std::string line1;
+  int lineNumber = 0;
+  while (std::getline(stream, line)) {
+    lineNumber++;
+    line = trim(line);
+    if (line.starts_with("1 ") && line1.empty()) {
+      line1 = line;
+    } else if (line.starts_with("2 ") && !line1.empty()) {
+      // malformed element set is skipped, others are still usable
+      try {
+        const auto tle = Tle::parse(name, line1, line);
+        tles.insert_or_assign(tle.id, tle);
+      } catch (const std::exception& exception) {
+        Logger::warn(LABEL, "skipping invalid tle, line: {}, name: {}, error: {}", lineNumber, name, exception.what());
+      }
+      name.clear();
+      line1.clear();
+    } else if (!line.empty()) {
+      name = line;
+      line1.clear();
+    }
+  }
+  return tles;
+}
+
+Sgp4::Sgp4(const Tle& tle) : m_tle(tle) {
+  if (TWO_PI / tle.meanMotion >= DEEP_SPACE_PERIOD) {
+    throw std::runtime_error(fmt::format("deep space orbit not supported: {}", tle.id));
+  }
+  const auto eo = tle.eccentricity;
+  m_cosio = std::cos(tle.inclination);
+  m_sinio = std::sin(tle.inclination);
+  const auto theta2 = m_cosio * m_cosio;
+  m_x3thm1 = 3.0 * theta2 - 1.0;
+  m_x1mth2 = 1.0 - theta2;
+  m_x7thm1 = 7.0 * theta2 - 1.0;
+  const auto betao2 = 1.0 - eo * eo;
+  const auto betao = std::sqrt(betao2);
+
+  // recover original mean motion and semimajor axis
+  const auto a1 = std::pow(XKE / tle.meanMotion, TWO_THIRDS);
+  const auto del1 = 1.5 * CK2 * m_x3thm1 / (a1 * a1 * betao * betao2);
+  const auto ao = a1 * (1.0 - del1 * (0.5 * TWO_THIRDS + del1 * (1.0 + 134.0 / 81.0 * del1)));
+  const auto delo = 1.5 * CK2 * m_x3thm1 / (ao * ao * betao * betao2);
+  m_xnodp = tle.meanMotion / (1.0 + delo);
+  m_aodp = ao / (1.0 - delo);
+  m_isSimple = m_aodp * (1.0 - eo) < 220.0 / XKMPER + 1.0;
+
+  // perigee below 156 km changes atmosphere parameters
+  auto s4 = S0;
+  auto qoms24 = QOMS2T;
+  const auto perigee = (m_aodp * (1.0 - eo) - 1.0) * XKMPER;
+  if (perigee < 156.0) {
+    s4 = perigee <= 98.0 ? 20.0 : perigee - 78.0;
+    qoms24 = std::pow((120.0 - s4) / XKMPER, 4.0);
+    s4 = s4 / XKMPER + 1.0;
+  }
+
+  const auto pinvsq = 1.0 / (m_aodp * m_aodp * betao2 * betao2);
+  const auto tsi = 1.0 / (m_aodp - s4);
+  m_eta = m_aodp * eo * tsi;
+  const auto etasq = m_eta * m_eta;
+  const auto eeta = eo * m_eta;
+  const auto psisq = std::fabs(1.0 - etasq);
+  const auto coef = qoms24 * std::pow(tsi, 4.0);
+  const auto coef1 = coef / std::pow(psisq, 3.5);
+  const auto c2 = coef1 * m_xnodp * (m_aodp * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) + 0.75 * CK2 * tsi / psisq * m_x3thm1 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+  m_c1 = tle.bstar * c2;
+  const auto c3 = eo > 1.0e-4 ? coef * tsi * A3OVK2 * m_xnodp * m_sinio / eo : 0.0;
+  m_c4 = 2.0 * m_xnodp * coef1 * m_aodp * betao2 *
+         (m_eta * (2.0 + 0.5 * etasq) + eo * (0.5 + 2.0 * etasq) -
+          2.0 * CK2 * tsi / (m_aodp * psisq) *
+              (-3.0 * m_x3thm1 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) + 0.75 * m_x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * std::cos(2.0 * tle.argumentOfPerigee)));
+  m_c5 = 2.0 * coef1 * m_aodp * betao2 * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+  // secular rates
+  const auto theta4 = theta2 * theta2;
+  const auto temp1 = 3.0 * CK2 * pinvsq * m_xnodp;
+  const auto temp2 = temp1 * CK2 * pinvsq;
+  const auto temp3 = 1.25 * CK4 * pinvsq * pinvsq * m_xnodp;
+  m_xmdot = m_xnodp + 0.5 * temp1 * betao * m_x3thm1 + 0.0625 * temp2 * betao * (13.0 - 78.0 * theta2 + 137.0 * theta4);
+  m_omgdot = -0.5 * temp1 * (1.0 - 5.0 * theta2) + 0.0625 * temp2 * (7.0 - 114.0 * theta2 + 395.0 * theta4) + temp3 * (3.0 - 36.0 * theta2 + 49.0 * theta4);
+  const auto xhdot1 = -temp1 * m_cosio;
+  m_xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * theta2) + 2.0 * temp3 * (3.0 - 7.0 * theta2)) * m_cosio;
+  m_omgcof = tle.bstar * c3 * std::cos(tle.argumentOfPerigee);
+  m_xmcof = eo > 1.0e-4 ? -TWO_THIRDS * coef * tle.bstar / eeta : 0.0;
+  m_xnodcf = 3.5 * betao2 * xhdot1 * m_c1;
+  m_t2cof = 1.5 * m_c1;
+  m_xlcof = 0.125 * A3OVK2 * m_sinio * (3.0 + 5.0 * m_cosio) / (1.0 + m_cosio);
+  m_aycof = 0.25 * A3OVK2 * m_sinio;
+  m_delmo = std::pow(1.0 + m_eta * std::cos(tle.meanAnomaly), 3.0);
+  m_sinmo = std::sin(tle.meanAnomaly);
+
+  m_d2 = m_d3 = m_d4 = m_t3cof = m_t4cof = m_t5cof = 0.0;
+  if (!m_isSimple) {
+    const auto c1sq = m_c1 * m_c1;
+    m_d2 = 4.0 * m_aodp * tsi * c1sq;
+    const auto temp = m_d2 * tsi * m_c1 / 3.0;
+    m_d3 = (17.0 * m_aodp + s4) * temp;
+    m_d4 = 0.5 * temp * m_aodp * tsi * (221.0 * m_aodp + 31.0 * s4) * m_c1;
+    m_t3cof = m_d2 + 2.0 * c1sq;
+    m_t4cof = 0.25 * (3.0 * m_d3 + m_c1 * (12.0 * m_d2 + 10.0 * c1sq));
+    m_t5cof = 0.2 * (3.0 * m_d4 + 12.0 * m_c1 * m_d3 + 6.0 * m_d2 * m_d2 + 15.0 * c1sq * (2.0 * m_d2 + c1sq));
+  }
+}
+
+std::array<double, 3> Sgp4::propagate(double minutes) const {
+  const auto t = minutes;
+  const auto bstar = m_tle.bstar;
+
+  // secular gravity and atmospheric drag
+  const auto xmdf = m_tle.meanAnomaly + m_xmdot * t;
+  const auto omgadf = m_tle.argumentOfPerigee + m_omgdot * t;
+  const auto xnoddf = m_tle.raan + m_xnodot * t;
+  auto omega = omgadf;
+  auto xmp = xmdf;
+  const auto tsq = t * t;
+  const auto xnode = xnoddf + m_xnodcf * tsq;
+  auto tempa = 1.0 - m_c1 * t;
+  auto tempe = bstar * m_c4 * t;
+  auto templ = m_t2cof * tsq;
+  if (!m_isSimple) {
+    const auto delomg = m_omgcof * t;
+    const auto delm = m_xmcof * (std::pow(1.0 + m_eta * std::cos(xmdf), 3.0) - m_delmo);
+    xmp = xmdf + delomg + delm;
+    omega = omgadf - delomg - delm;
+    const auto tcube = tsq * t;
+    const auto tfour = t * tcube;
+    tempa = tempa - m_d2 * tsq - m_d3 * tcube - m_d4 * tfour;
+    tempe = tempe + bstar * m_c5 * (std::sin(xmp) - m_sinmo);
+    templ = templ + m_t3cof * tcube + tfour * (m_t4cof + t * m_t5cof);
+  }
+  const auto a = m_aodp * tempa * tempa;
+  const auto e = m_tle.eccentricity - tempe;
+  const auto xl = xmp + omega + xnode + m_xnodp * templ;
+  const auto beta = std::sqrt(1.0 - e * e);
+
+  // long period periodics
+  const auto axn = e * std::cos(omega);
+  const auto aynl = m_aycof / (a * beta * beta);
+  const auto xll = m_xlcof * axn / (a * beta * beta);
+  const auto xlt = xl + xll;
+  const auto ayn = e * std::sin(omega) + aynl;
+
+  // kepler equation
+  const auto capu = std::fmod(xlt - xnode, TWO_PI);
+  auto epw = capu;
+  auto sinepw = 0.0;
+  auto cosepw = 0.0;
+  for (int i = 0; i < KEPLER_ITERATIONS; ++i) {
+    sinepw = std::sin(epw);
+    cosepw = std::cos(epw);
+    const auto next = (capu - ayn * cosepw + axn * sinepw - epw) / (1.0 - axn * cosepw - ayn * sinepw) + epw;
+    if (std::fabs(next - epw) <= 1.0e-6) {
+      epw = next;
+      break;
+    }
+    epw = next;
+  }
+  sinepw = std::sin(epw);
+  cosepw = std::cos(epw);
+
+  // short period preliminary quantities
+  const auto ecose = axn * cosepw + ayn * sinepw;
+  const auto esine = axn * sinepw - ayn * cosepw;
+  const auto elsq = axn * axn + ayn * ayn;
+  const auto pl = a * (1.0 - elsq);
+  const auto r = a * (1.0 - ecose);
+  const auto betal = std::sqrt(1.0 - elsq);
+  const auto cosu = a / r * (cosepw - axn + ayn * esine / (1.0 + betal));
+  const auto sinu = a / r * (sinepw - ayn - axn * esine / (1.0 + betal));
+  const auto u = std::atan2(sinu, cosu);
+  const auto sin2u = 2.0 * sinu * cosu;
+  const auto cos2u = 2.0 * cosu * cosu - 1.0;
+  const auto temp1 = CK2 / pl;
+  const auto temp2 = temp1 / pl;
+
+  // short periodics
+  const auto rk = r * (1.0 - 1.5 * temp2 * betal * m_x3thm1) + 0.5 * temp1 * m_x1mth2 * cos2u;
+  const auto uk = u - 0.25 * temp2 * m_x7thm1 * sin2u;
+  const auto xnodek = xnode + 1.5 * temp2 * m_cosio * sin2u;
+  const auto xinck = m_tle.inclination + 1.5 * temp2 * m_cosio * m_sinio * cos2u;
+
+  const auto sinuk = std::sin(uk);
+  const auto cosuk = std::cos(uk);
+  const auto sinik = std::sin(xinck);
+  const auto cosik = std::cos(xinck);
+  const auto sinnok = std::sin(xnodek);
+  const auto cosnok = std::cos(xnodek);
+  const auto xmx = -sinnok * cosik;
+  const auto xmy = cosnok * cosik;
+  return {rk * (xmx * sinuk + cosnok * cosuk) * XKMPER, rk * (xmy * sinuk + sinnok * cosuk) * XKMPER, rk * sinik * sinuk * XKMPER};
+}
+
+double Sgp4::getElevation(const std::chrono::milliseconds& time, double latitude, double longitude, double altitude) const {
+  return getLookAngle(time, latitude, longitude, altitude).first;
+}
+
+double Sgp4::getRangeRate(const std::chrono::milliseconds& time, double latitude, double longitude, double altitude) const {
+  const auto before = getLookAngle(time - RANGE_RATE_STEP / 2, latitude, longitude, altitude).second;
+  const auto after = getLookAngle(time + RANGE_RATE_STEP / 2, latitude, longitude, altitude).second;
+  return (after - before) / std::chrono::duration<double>(RANGE_RATE_STEP).count();
+}
+
+std::pair<double, double> Sgp4::getLookAngle(const std::chrono::milliseconds& time, double latitude, double longitude, double altitude) const {
+  const auto minutes = std::chrono::duration<double, std::ratio<60>>(time - m_tle.epoch).count();
+  const auto [x, y, z] = propagate(minutes);
+
+  // teme to earth fixed, polar motion ignored
+  const auto gmst = getGmst(time);
+  const auto satX = std::cos(gmst) * x + std::sin(gmst) * y;
+  const auto satY = -std::sin(gmst) * x + std::cos(gmst) * y;
+  const auto satZ = z;
+
+  const auto lat = latitude * DEG_TO_RAD;
+  const auto lon = longitude * DEG_TO_RAD;
+  const auto e2 = WGS84_F * (2.0 - WGS84_F);
+  const auto n = WGS84_A / std::sqrt(1.0 - e2 * std::sin(lat) * std::sin(lat));
+  const auto h = altitude / 1000.0;
+  const auto obsX = (n + h) * std::cos(lat) * std::cos(lon);
+  const auto obsY = (n + h) * std::cos(lat) * std::sin(lon);
+  const auto obsZ = (n * (1.0 - e2) + h) * std::sin(lat);
+
+  const auto dx = satX - obsX;
+  const auto dy = satY - obsY;
+  const auto dz = satZ - obsZ;
+  const auto range = std::sqrt(dx * dx + dy * dy + dz * dz);
+  const auto up = dx * std::cos(lat) * std::cos(lon) + dy * std::cos(lat) * std::sin(lon) + dz * std::sin(lat);
+  return {std::asin(up / range) / DEG_TO_RAD, range};
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+
+struct Tle {
+  int id;
+  std::string name;
+  std::chrono::milliseconds epoch;
+  double inclination;  // rad
+  double raan;         // rad
+  double eccentricity;
+  double argumentOfPerigee;  // rad
+  double meanAnomaly;        // rad
+  double meanMotion;         // rad per minute
+  double bstar;
+
+  // two line element set with optional name line
+  static Tle parse(const std::string& name, const std::string& line1, const std::string& line2);
+  // tle file content, elements are indexed by catalog number
+  static std::map<int, Tle> parseFile(const std::string& content);
+};
+
+// near earth sgp4 propagator (spacetrack report 3, wgs72), deep space orbits with period over 225 minutes are not supported
+class Sgp4 {
+ public:
+  explicit Sgp4(const Tle& tle);
+
+  // teme position in km, minutes since tle epoch
+  std::array<double, 3> propagate(double minutes) const;
+  // degrees above observer horizon at given unix time
+  double getElevation(const std::chrono::milliseconds& time, double latitude, double longitude, double altitude) const;
+  // line of sight velocity in km/s, positive when satellite moves away from observer
+  double getRangeRate(const std::chrono::milliseconds& time, double latitude, double longitude, double altitude) const;
+
+ private:
+  // elevation in degrees and range in km
+  std::pair<double, double> getLookAngle(const std::chrono::milliseconds& time, double latitude, double longitude, double altitude) const;
+
+  Tle m_tle;
+  bool m_isSimple;
+  double m_aodp, m_xnodp, m_cosio, m_sinio, m_x3thm1, m_x1mth2, m_x7thm1, m_eta;
+  double m_c1, m_c4, m_c5, m_d2, m_d3, m_d4, m_delmo, m_sinmo;
+  double m_xmdot, m_omgdot, m_xnodot, m_omgcof, m_xmcof, m_xnodcf;
+  double m_t2cof, m_t3cof, m_t4cof, m_t5cof, m_xlcof, m_aycof;
+};
@@ -0,0 +1,34 @@
+#include "thread_utils.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+constexpr auto MAX_THREAD_NAME_SIZE = 15;  // linux limit without null terminator
+
+void setThreadName(const std::string& name) { pthread_setname_np(pthread_self(), name.substr(0, MAX_THREAD_NAME_SIZE).c_str()); }
+
+bool isValidCore(int core) { return 0 <= core && core < std::min<long>(CPU_SETSIZE, sysconf(_SC_NPROCESSORS_ONLN)); }
+
+bool setThreadAffinity(const std::vector<int>& cores) {
+  if (cores.empty()) {
+    return true;
+  }
+  if (!std::all_of(cores.begin(), cores.end(), isValidCore)) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const auto core : cores) {
+    CPU_SET(core, &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool setThreadRealtimePriority(int priority) {
+  sched_param param{};
+  param.sched_priority = priority;
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// names calling thread, visible in top -H and perf, truncated to 15 characters
+void setThreadName(const std::string& name);
+
+// core id accepted by affinity calls, below online cpu count
+bool isValidCore(int core);
+
+// pins calling thread to cores, empty list keeps default affinity, invalid cores fail without pinning
+bool setThreadAffinity(const std::vector<int>& cores);
+
+// switches calling thread to SCHED_FIFO, fails without CAP_SYS_NICE or rtprio limit
+bool setThreadRealtimePriority(int priority);
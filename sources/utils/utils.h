@@ -19,11 +19,22 @@ int roundUp(const int value, const int factor);
 int roundDown(const int value, const int factor);
 
 template <typename T>
-std::string encode_base64(const T* data, std::size_t size) {
+std::size_t encoded_base64_size(std::size_t size) {
+  return boost::beast::detail::base64::encoded_size(sizeof(T) * size);
+}
+
+template <typename T>
+void append_base64(std::string& out, const T* data, std::size_t size) {
   const auto bytes = sizeof(T) * size;
+  const auto offset = out.size();
+  out.resize(offset + boost::beast::detail::base64::encoded_size(bytes));
+  std::size_t written = boost::beast::detail::base64::encode(out.data() + offset, data, bytes);
+  out.resize(offset + written);
+}
+
+template <typename T>
+std::string encode_base64(const T* data, std::size_t size) {
   std::string out;
-  out.resize(boost::beast::detail::base64::encoded_size(bytes));
-  std::size_t written = boost::beast::detail::base64::encode(out.data(), data, bytes);
-  out.resize(written);
+  append_base64(out, data, size);
   return out;
 }
\ No newline at end of file
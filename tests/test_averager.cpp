@@ -138,3 +138,48 @@ TEST(Averager, SimpleTest) {
   EXPECT_EQ(avg.average(), generate(8));
   EXPECT_EQ(avg.data(), generateRaw(3, 10, 11));
 }
+
+TEST(Averager, ReducedPrecision) {
+  const int size = 64;
+  for (const auto& [precision, step] : std::vector<std::pair<Averager::Precision, float>>{
+           {Averager::Precision::Float16, 0.05f}, {Averager::Precision::Int16, 0.125f}, {Averager::Precision::Int8, 0.25f}}) {
+    Averager avg(size, GROUP_SIZE, precision);
+    Averager reference(size, GROUP_SIZE);
+    for (int frame = 0; frame < 1000; ++frame) {
+      std::vector<float> data(size);
+      for (int i = 0; i < size; ++i) {
+        data[i] = std::fmod(frame * 7.31f + i * 3.17f, 90.0f) - 30.0f;
+      }
+      avg.push(data.data());
+      reference.push(data.data());
+    }
+
+    const auto rows = avg.data();
+    for (int i = 0; i < size; ++i) {
+      EXPECT_NEAR(avg.average()[i], reference.average()[i], step);
+      float sum = 0.0f;
+      for (const auto& row : rows) {
+        sum += row[i];
+      }
+      // sums are updated incrementally, int steps are exact in float so there is no drift
+      if (precision != Averager::Precision::Float16) {
+        EXPECT_EQ(avg.average()[i], sum / GROUP_SIZE);
+      }
+    }
+    for (int frame = 0; frame < avg.frames(); ++frame) {
+      for (int i = 0; i < size; ++i) {
+        EXPECT_NEAR(avg.get(frame, i), reference.get(frame, i), step);
+      }
+    }
+  }
+}
+
+TEST(Averager, ReducedPrecisionMaxIndex) {
+  Averager avg(SIZE, 1, Averager::Precision::Int8);
+  avg.push(std::vector<float>{-90.0f, 1.0f, 12.3f, 11.9f, 70.0f}.data());
+  EXPECT_EQ(avg.getMaxIndex(0, 2, 3), 2);
+  EXPECT_EQ(avg.getMaxIndex(0, 3, 3), 4);
+  EXPECT_EQ(avg.get(0, 0), -64.0f);
+  EXPECT_EQ(avg.get(0, 2), 12.5f);
+  EXPECT_EQ(avg.get(0, 4), 63.5f);
+}
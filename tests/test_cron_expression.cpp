@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <utils/cron_expression.h>
+
+#include <chrono>
+
+using namespace std::chrono;
+
+namespace {
+
+seconds toSeconds(const year_month_day& date, const hours& h, const minutes& m, const seconds& s = seconds(0)) { return (sys_days(date) + h + m + s).time_since_epoch(); }
+
+}  // namespace
+
+TEST(CronExpression, EveryMinute) {
+  const CronExpression expression("* * * * *");
+  const auto now = toSeconds(2024y / 5 / 10, hours(12), minutes(30), seconds(15));
+  EXPECT_EQ(expression.next(now), toSeconds(2024y / 5 / 10, hours(12), minutes(31)));
+}
+
+TEST(CronExpression, StepsAndRanges) {
+  const CronExpression expression("*/15 8-10 * * *");
+  EXPECT_EQ(expression.next(toSeconds(2024y / 5 / 10, hours(7), minutes(50))), toSeconds(2024y / 5 / 10, hours(8), minutes(0)));
+  EXPECT_EQ(expression.next(toSeconds(2024y / 5 / 10, hours(8), minutes(0))), toSeconds(2024y / 5 / 10, hours(8), minutes(15)));
+  EXPECT_EQ(expression.next(toSeconds(2024y / 5 / 10, hours(10), minutes(45))), toSeconds(2024y / 5 / 11, hours(8), minutes(0)));
+}
+
+TEST(CronExpression, Names) {
+  // 2024-05-10 is friday
+  const CronExpression expression("30 6 * JAN,jun mon-wed");
+  EXPECT_EQ(expression.next(toSeconds(2024y / 5 / 10, hours(0), minutes(0))), toSeconds(2024y / 6 / 3, hours(6), minutes(30)));
+}
+
+TEST(CronExpression, DayOrWeekday) {
+  // both restricted matches either, 2024-05-12 is sunday
+  const CronExpression expression("0 0 15 * 0");
+  EXPECT_EQ(expression.next(toSeconds(2024y / 5 / 10, hours(0), minutes(0))), toSeconds(2024y / 5 / 12, hours(0), minutes(0)));
+  EXPECT_EQ(expression.next(toSeconds(2024y / 5 / 12, hours(0), minutes(0))), toSeconds(2024y / 5 / 15, hours(0), minutes(0)));
+  EXPECT_EQ(CronExpression("0 0 * * 7").next(toSeconds(2024y / 5 / 10, hours(0), minutes(0))), toSeconds(2024y / 5 / 12, hours(0), minutes(0)));
+}
+
+TEST(CronExpression, Seconds) {
+  const CronExpression expression("10,40 * * * * *");
+  EXPECT_EQ(expression.next(toSeconds(2024y / 5 / 10, hours(12), minutes(0), seconds(10))), toSeconds(2024y / 5 / 10, hours(12), minutes(0), seconds(40)));
+  EXPECT_EQ(expression.next(toSeconds(2024y / 5 / 10, hours(12), minutes(0), seconds(40))), toSeconds(2024y / 5 / 10, hours(12), minutes(1), seconds(10)));
+}
+
+TEST(CronExpression, Impossible) {
+  EXPECT_EQ(CronExpression("0 0 30 2 *").next(toSeconds(2024y / 5 / 10, hours(0), minutes(0))), std::nullopt);
+  EXPECT_THROW(CronExpression("0 0 *"), std::runtime_error);
+  EXPECT_THROW(CronExpression("61 * * * *"), std::runtime_error);
+  EXPECT_THROW(CronExpression("a * * * *"), std::runtime_error);
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <radio/fft_plan.h>
+
+#include <cmath>
+#include <complex>
+#include <filesystem>
+#include <numbers>
+#include <vector>
+
+namespace {
+
+constexpr auto FFT_SIZE = 16;
+constexpr auto TOLERANCE = 1e-3;
+
+std::vector<float> hamming(int size) {
+  std::vector<float> window(size);
+  for (int i = 0; i < size; ++i) {
+    window[i] = 0.54f - 0.46f * std::cos(2.0f * std::numbers::pi_v<float> * i / (size - 1));
+  }
+  return window;
+}
+
+std::vector<std::complex<float>> generate(int frames) {
+  std::vector<std::complex<float>> data(frames * FFT_SIZE);
+  for (int i = 0; i < static_cast<int>(data.size()); ++i) {
+    data[i] = {std::sin(0.3f * i) + 0.1f * (i % 7), std::cos(0.7f * i) - 0.05f * (i % 5)};
+  }
+  return data;
+}
+
+// direct dft of windowed frame with dc moved to the middle, as fft_v with shift
+std::vector<std::complex<float>> reference(const std::complex<float>* input, const std::vector<float>& window) {
+  std::vector<std::complex<float>> output(FFT_SIZE);
+  for (int k = 0; k < FFT_SIZE; ++k) {
+    std::complex<double> sum = 0.0;
+    for (int j = 0; j < FFT_SIZE; ++j) {
+      sum += std::complex<double>(input[j]) * static_cast<double>(window[j]) * std::polar(1.0, -2.0 * std::numbers::pi * k * j / FFT_SIZE);
+    }
+    output[(k + FFT_SIZE / 2) % FFT_SIZE] = std::complex<float>(sum);
+  }
+  return output;
+}
+
+void expectReference(FftPlan& plan, const std::vector<float>& window, int frames) {
+  const auto input = generate(frames);
+  std::vector<std::complex<float>> output(input.size());
+  plan.transform(input.data(), output.data(), frames);
+  for (int frame = 0; frame < frames; ++frame) {
+    const auto expected = reference(&input[frame * FFT_SIZE], window);
+    for (int k = 0; k < FFT_SIZE; ++k) {
+      EXPECT_NEAR(output[frame * FFT_SIZE + k].real(), expected[k].real(), TOLERANCE) << "frame: " << frame << ", bin: " << k;
+      EXPECT_NEAR(output[frame * FFT_SIZE + k].imag(), expected[k].imag(), TOLERANCE) << "frame: " << frame << ", bin: " << k;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(FftPlan, SingleFrame) {
+  const auto window = hamming(FFT_SIZE);
+  FftPlan plan(FFT_SIZE, window, 1, 1);
+  expectReference(plan, window, 3);
+}
+
+TEST(FftPlan, BatchWithRemainder) {
+  const auto window = hamming(FFT_SIZE);
+  FftPlan plan(FFT_SIZE, window, 4, 2);
+  expectReference(plan, window, 11);
+}
+
+TEST(FftPlan, Prepared) {
+  const auto wisdomFile = (std::filesystem::temp_directory_path() / "test_fft_plan_wisdom").string();
+  const auto window = hamming(FFT_SIZE);
+  FftPlan::prepare(wisdomFile, FFT_SIZE, 2, 1);
+  FftPlan plan(FFT_SIZE, window, 2, 1);
+  expectReference(plan, window, 5);
+  std::filesystem::remove(wisdomFile);
+}
@@ -0,0 +1,57 @@
+#include <file_config.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+Device createDevice(const std::string& driver, const std::string& serial, const std::string& gain) {
+  Device device;
+  device.connected = true;
+  device.driver = driver;
+  device.serial = serial;
+  device.gains = {{gain, 0.0, 0.0, 50.0, 1.0, {}}};
+  return device;
+}
+
+nlohmann::json createJson(const std::vector<Device>& devices) {
+  nlohmann::json json = FileConfig{};
+  json["devices"] = devices;
+  return json;
+}
+
+}  // namespace
+
+TEST(FileConfig, DevicesSharingSerial) {
+  FileConfig current;
+  current.devices = {createDevice("rtlsdr", "00000001", "TUNER"), createDevice("rtlsdr", "00000001", "LNA"), createDevice("hackrf", "00000001", "VGA")};
+
+  auto first = createDevice("", "00000001", "TUNER");
+  first.connected = false;
+  first.gains[0].value = 10.0;
+  auto second = createDevice("", "00000001", "LNA");
+  second.connected = false;
+  second.gains[0].value = 20.0;
+  const auto config = FileConfig::fromJson(createJson({first, second}), current);
+
+  ASSERT_EQ(config.devices.size(), 2);
+  EXPECT_TRUE(config.devices[0].connected);
+  EXPECT_EQ(config.devices[0].driver, "rtlsdr");
+  EXPECT_EQ(config.devices[0].gains[0].name, "TUNER");
+  EXPECT_EQ(config.devices[0].gains[0].value, 10.0);
+  EXPECT_TRUE(config.devices[1].connected);
+  EXPECT_EQ(config.devices[1].driver, "rtlsdr");
+  EXPECT_EQ(config.devices[1].gains[0].name, "LNA");
+  EXPECT_EQ(config.devices[1].gains[0].value, 20.0);
+}
+
+TEST(FileConfig, DevicesMatchedByDriver) {
+  FileConfig current;
+  current.devices = {createDevice("rtlsdr", "00000001", "TUNER"), createDevice("hackrf", "00000001", "VGA"), createDevice("airspy", "", "LNA")};
+
+  const auto config = FileConfig::fromJson(createJson({createDevice("hackrf", "00000001", "VGA"), createDevice("airspy", "", "LNA")}), current);
+
+  ASSERT_EQ(config.devices.size(), 2);
+  EXPECT_EQ(config.devices[0].driver, "hackrf");
+  EXPECT_EQ(config.devices[0].gains[0].name, "VGA");
+  EXPECT_EQ(config.devices[1].driver, "airspy");
+  EXPECT_EQ(config.devices[1].gains[0].name, "LNA");
+}
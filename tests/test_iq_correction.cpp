@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <radio/iq_correction.h>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace {
+
+// tone at given normalized frequency with dc offset, q gain and phase error
+std::vector<std::complex<float>> generate(int size, float frequency, std::complex<float> dc, float gain, float phase) {
+  std::vector<std::complex<float>> data(size);
+  for (int i = 0; i < size; ++i) {
+    const auto angle = 2.0f * std::numbers::pi_v<float> * frequency * i;
+    data[i] = {std::cos(angle) + dc.real(), gain * std::sin(angle + phase) + dc.imag()};
+  }
+  return data;
+}
+
+// power of mirrored image relative to tone
+float getImageRejection(const std::vector<std::complex<float>>& data, float frequency) {
+  std::complex<float> tone = 0.0f;
+  std::complex<float> image = 0.0f;
+  for (size_t i = 0; i < data.size(); ++i) {
+    const auto angle = 2.0f * std::numbers::pi_v<float> * frequency * i;
+    tone += data[i] * std::polar(1.0f, -angle);
+    image += data[i] * std::polar(1.0f, angle);
+  }
+  return 20.0f * std::log10(std::abs(image) / std::abs(tone));
+}
+
+}  // namespace
+
+TEST(IqCorrection, RemovesDc) {
+  const auto input = generate(8192, 0.01f, {0.3f, -0.2f}, 1.0f, 0.0f);
+  std::vector<std::complex<float>> output(input.size());
+  IqCorrection correction(4096);
+  correction.process(input.data(), output.data(), input.size());
+  EXPECT_NEAR(correction.dc().real(), 0.3f, 1e-3);
+  EXPECT_NEAR(correction.dc().imag(), -0.2f, 1e-3);
+
+  std::complex<float> sum = 0.0f;
+  for (const auto& value : output) {
+    sum += value;
+  }
+  EXPECT_LT(std::abs(sum / static_cast<float>(output.size())), 1e-3);
+}
+
+TEST(IqCorrection, BalancesIq) {
+  const auto frequency = 0.0123f;
+  const auto input = generate(16384, frequency, {0.0f, 0.0f}, 1.2f, 0.1f);
+  std::vector<std::complex<float>> output(input.size());
+  IqCorrection correction(4096);
+  for (int i = 0; i < 4; ++i) {
+    correction.process(input.data(), output.data(), input.size());
+  }
+  EXPECT_GT(getImageRejection(input, frequency), -25.0f);
+  EXPECT_LT(getImageRejection(output, frequency), -50.0f);
+}
+
+TEST(IqCorrection, Empty) {
+  std::vector<std::complex<float>> input(1024, 0.0f);
+  std::vector<std::complex<float>> output(input.size(), 1.0f);
+  IqCorrection correction(4096);
+  correction.process(input.data(), output.data(), input.size());
+  EXPECT_EQ(correction.gain(), 1.0f);
+  EXPECT_EQ(correction.phase(), 0.0f);
+  EXPECT_EQ(output[0], std::complex<float>(0.0f, 0.0f));
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include <latency_histogram.h>
+
+TEST(LatencyHistogram, Index) {
+  for (uint64_t value : {0ul, 1ul, 63ul, 64ul, 65ul, 127ul, 128ul, 1000ul, 123456789ul, 1ul << 40, ~0ul}) {
+    const auto index = LatencyHistogram::toIndex(value);
+    EXPECT_LE(value, LatencyHistogram::toValue(index));
+    EXPECT_LE(LatencyHistogram::toValue(index) - value, value / 32) << value;
+    if (0 < index) {
+      EXPECT_LT(LatencyHistogram::toValue(index - 1), value);
+    }
+  }
+}
+
+TEST(LatencyHistogram, Percentiles) {
+  LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    histogram.record(i * 1000);
+  }
+  const auto snapshot = histogram.snapshot(true);
+  EXPECT_EQ(snapshot.count, 1000);
+  EXPECT_NEAR(snapshot.p50, 500000, 500000 / 32);
+  EXPECT_NEAR(snapshot.p99, 990000, 990000 / 32);
+  EXPECT_NEAR(snapshot.p999, 999000, 999000 / 32);
+  EXPECT_EQ(snapshot.max, 1000000);
+  EXPECT_EQ(histogram.snapshot(false).count, 0);
+}
+
+TEST(LatencyHistogram, Empty) {
+  LatencyHistogram histogram;
+  const auto snapshot = histogram.snapshot(false);
+  EXPECT_EQ(snapshot.count, 0);
+  EXPECT_EQ(snapshot.p99, 0);
+  EXPECT_EQ(snapshot.max, 0);
+}
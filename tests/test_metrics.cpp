@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+#include <metrics.h>
+
+TEST(Metrics, Counter) {
+  auto& counter = Metrics::counter("test_counter_total", "test counter", {{"device", "a"}});
+  counter.inc();
+  counter.inc(2);
+  EXPECT_EQ(counter.value(), 3);
+  EXPECT_EQ(&counter, &Metrics::counter("test_counter_total", "test counter", {{"device", "a"}}));
+  EXPECT_NE(&counter, &Metrics::counter("test_counter_total", "test counter", {{"device", "b"}}));
+}
+
+TEST(Metrics, TypeMismatch) {
+  Metrics::counter("test_type_total", "test");
+  EXPECT_THROW(Metrics::gauge("test_type_total", "test"), std::runtime_error);
+}
+
+TEST(Metrics, Histogram) {
+  Histogram histogram({1.0, 2.0, 4.0});
+  histogram.observe(0.5);
+  histogram.observe(1.0);
+  histogram.observe(3.0);
+  histogram.observe(10.0);
+  EXPECT_EQ(histogram.cumulativeCounts(), std::vector<uint64_t>({2, 2, 3, 4}));
+  EXPECT_EQ(histogram.count(), 4);
+  EXPECT_DOUBLE_EQ(histogram.sum(), 14.5);
+}
+
+TEST(Metrics, Serialize) {
+  Metrics::gauge("test_serialize_gauge", "test gauge", {{"lane", "con\"trol"}}).set(1.5);
+  Metrics::histogram("test_serialize_seconds", "test histogram", {}, {0.5}).observe(0.25);
+  const auto text = Metrics::serialize();
+  EXPECT_NE(text.find("# TYPE test_serialize_gauge gauge\ntest_serialize_gauge{lane=\"con\\\"trol\"} 1.5\n"), std::string::npos);
+  EXPECT_NE(text.find("test_serialize_seconds_bucket{le=\"0.5\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("test_serialize_seconds_bucket{le=\"+Inf\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("test_serialize_seconds_count 1\n"), std::string::npos);
+}
@@ -122,11 +122,40 @@ TEST(RadioUtils, RangeSplitSampleRate) {
   EXPECT_EQ(getRangeSplitSampleRate(250000), 200000);
 }
 
-TEST(RadioUtils, SplitRanges) {
+TEST(RadioUtils, SubtractRanges) {
   using Ranges = std::vector<FrequencyRange>;
-  EXPECT_EQ(splitRange({140000000, 160000000}, 20000000), Ranges({{140000000, 160000000}}));
-  EXPECT_EQ(splitRange({140000000, 180000000}, 20000000), Ranges({{140000000, 160000000}, {160000000, 180000000}}));
-  EXPECT_EQ(splitRange({140000000, 200000000}, 20000000), Ranges({{140000000, 160000000}, {160000000, 180000000}, {180000000, 200000000}}));
-  EXPECT_EQ(splitRange({140000000, 145000000}, 2000000), Ranges({{140000000, 142000000}, {142000000, 144000000}, {144000000, 146000000}}));
-  EXPECT_EQ(splitRange({140000000, 150000000}, 2000000), Ranges({{140000000, 142000000}, {142000000, 144000000}, {144000000, 146000000}, {146000000, 148000000}, {148000000, 150000000}}));
+  EXPECT_EQ(subtractRanges({{150, 160}, {100, 120}, {110, 130}}, {}), Ranges({{100, 130}, {150, 160}}));
+  EXPECT_EQ(subtractRanges({{100, 200}}, {{120, 130}, {190, 250}}), Ranges({{100, 120}, {130, 190}}));
+  EXPECT_EQ(subtractRanges({{100, 200}}, {{50, 250}}), Ranges({}));
+}
+
+TEST(RadioUtils, PlanRanges) {
+  using Ranges = std::vector<FrequencyRange>;
+  // wide ranges are tiled like split ranges
+  EXPECT_EQ(planRanges({{140000000, 160000000}}, 20000000, 25000), Ranges({{140000000, 160000000}}));
+  EXPECT_EQ(planRanges({{140000000, 180000000}}, 20000000, 25000), Ranges({{140000000, 160000000}, {160000000, 180000000}}));
+  // last part is narrower instead of exceeding range
+  EXPECT_EQ(planRanges({{140000000, 145000000}}, 2000000, 25000), Ranges({{140000000, 142000000}, {142000000, 144000000}, {144000000, 145000000}}));
+  // small ranges share tuning, dc in gap between them
+  EXPECT_EQ(planRanges({{144000000, 144500000}, {145000000, 145500000}}, 2000000, 25000), Ranges({{144000000, 145500000}}));
+  EXPECT_EQ(planRanges({{433000000, 434000000}, {144000000, 144500000}, {145000000, 145500000}}, 2000000, 25000), Ranges({{144000000, 145500000}, {433000000, 434000000}}));
+  // gap narrower than guard keeps dc in middle
+  EXPECT_EQ(planRanges({{144000000, 144500000}, {144525000, 145500000}}, 2000000, 25000), Ranges({{144000000, 145500000}}));
+  // narrow range is moved next to dc
+  EXPECT_EQ(planRanges({{433000000, 433500000}}, 2000000, 25000), Ranges({{432450000, 433500000}}));
+}
+
+TEST(RadioUtils, AssignRanges) {
+  using Ranges = std::vector<FrequencyRange>;
+  using Assignment = std::vector<Ranges>;
+  EXPECT_EQ(assignRanges({}, {1.0, 1.0}, 1000000), Assignment({{}, {}}));
+  EXPECT_EQ(assignRanges({{140000000, 160000000}}, {1.0}, 2000000), Assignment({{{140000000, 160000000}}}));
+  EXPECT_EQ(assignRanges({{140000000, 160000000}}, {1.0, 1.0}, 2000000), Assignment({{{140000000, 150000000}}, {{150000000, 160000000}}}));
+  EXPECT_EQ(assignRanges({{140000000, 160000000}}, {3.0, 1.0}, 2000000), Assignment({{{140000000, 156000000}}, {{156000000, 160000000}}}));
+  EXPECT_EQ(assignRanges({{140000000, 160000000}}, {1.0, 0.0}, 2000000), Assignment({{{140000000, 160000000}}, {}}));
+  EXPECT_EQ(assignRanges({{140000000, 160000000}}, {0.0, 1.0}, 2000000), Assignment({{}, {{140000000, 160000000}}}));
+  EXPECT_EQ(
+      assignRanges({{430000000, 440000000}, {144000000, 146000000}}, {1.0, 1.0}, 1000000),
+      Assignment({{{144000000, 146000000}, {430000000, 434000000}}, {{434000000, 440000000}}}));
+  EXPECT_EQ(assignRanges({{144000000, 146000000}}, {1.0, 1.0, 1.0}, 1000000), Assignment({{{144000000, 145000000}}, {}, {{145000000, 146000000}}}));
 }
@@ -6,14 +6,14 @@
 using namespace std::chrono_literals;
 
 TEST(Scheduler, Transmissions) {
-  std::list<ScheduledTransmission> scheduledTransmissions;
+  ScheduleQueue scheduledTransmissions;
   const Frequency f1(700);
   const Frequency f2(800);
   const Frequency f3(800);
 
-  scheduledTransmissions.emplace_back("", "", 100s, 200s, f1, 20, "");
-  scheduledTransmissions.emplace_back("", "", 150s, 200s, f2, 20, "");
-  scheduledTransmissions.emplace_back("", "", 250s, 300s, f3, 20, "");
+  scheduledTransmissions.push({"", "", 100s, 200s, f1, 20, ""});
+  scheduledTransmissions.push({"", "", 150s, 200s, f2, 20, ""});
+  scheduledTransmissions.push({"", "", 250s, 300s, f3, 20, ""});
 
   {
     const auto result = Scheduler::getTransmissions(10s, scheduledTransmissions);
@@ -64,16 +64,16 @@ TEST(Scheduler, Transmissions) {
 }
 
 TEST(Scheduler, Recordings) {
-  std::list<ScheduledTransmission> scheduledTransmissions;
+  ScheduleQueue scheduledTransmissions;
   const Frequency f1(7000);
   const Frequency f2(7500);
   const Frequency f3(8050);
   const Frequency sampleRate(2000);
   const Frequency shift(100);
 
-  scheduledTransmissions.emplace_back("", "", 100s, 300s, f1, 100, "");
-  scheduledTransmissions.emplace_back("", "", 150s, 300s, f2, 100, "");
-  scheduledTransmissions.emplace_back("", "", 200s, 300s, f3, 100, "");
+  scheduledTransmissions.push({"", "", 100s, 300s, f1, 100, ""});
+  scheduledTransmissions.push({"", "", 150s, 300s, f2, 100, ""});
+  scheduledTransmissions.push({"", "", 200s, 300s, f3, 100, ""});
 
   {
     const auto result = Scheduler::getRecordings(125s, scheduledTransmissions, sampleRate, shift);
@@ -99,7 +99,7 @@ TEST(Scheduler, Recordings) {
 }
 
 TEST(Scheduler, RecordingsEdgeCase) {
-  std::list<ScheduledTransmission> scheduledTransmissions;
+  ScheduleQueue scheduledTransmissions;
   const Frequency f1(7000);
   const Frequency f2(6149);
   const Frequency f3(6150);
@@ -108,11 +108,11 @@ TEST(Scheduler, RecordingsEdgeCase) {
   const Frequency sampleRate(2000);
   const Frequency shift(100);
 
-  scheduledTransmissions.emplace_back("", "", 200s, 300s, f1, 100, "");
-  scheduledTransmissions.emplace_back("", "", 200s, 300s, f2, 100, "");
-  scheduledTransmissions.emplace_back("", "", 200s, 300s, f3, 100, "");
-  scheduledTransmissions.emplace_back("", "", 200s, 300s, f4, 100, "");
-  scheduledTransmissions.emplace_back("", "", 200s, 300s, f5, 100, "");
+  scheduledTransmissions.push({"", "", 200s, 300s, f1, 100, ""});
+  scheduledTransmissions.push({"", "", 200s, 300s, f2, 100, ""});
+  scheduledTransmissions.push({"", "", 200s, 300s, f3, 100, ""});
+  scheduledTransmissions.push({"", "", 200s, 300s, f4, 100, ""});
+  scheduledTransmissions.push({"", "", 200s, 300s, f5, 100, ""});
 
   {
     const auto result = Scheduler::getRecordings(250s, scheduledTransmissions, sampleRate, shift);
@@ -123,3 +123,52 @@ TEST(Scheduler, RecordingsEdgeCase) {
     EXPECT_EQ(result->second[2].shift(), 950);
   }
 }
+
+TEST(Scheduler, NextEventTime) {
+  ScheduleQueue scheduledTransmissions;
+  EXPECT_EQ(scheduledTransmissions.getNextEventTime(), std::chrono::milliseconds::max());
+
+  scheduledTransmissions.push({"", "", 250s, 300s, 800, 20, ""});
+  scheduledTransmissions.push({"", "", 100s, 200s, 700, 20, ""});
+  EXPECT_EQ(scheduledTransmissions.getNextEventTime(), 100s);
+
+  scheduledTransmissions.advance(150s);
+  EXPECT_EQ(scheduledTransmissions.getActive().size(), 1);
+  EXPECT_EQ(scheduledTransmissions.getNextEventTime(), 200001ms);
+
+  scheduledTransmissions.advance(200001ms);
+  EXPECT_EQ(scheduledTransmissions.getActive().size(), 0);
+  EXPECT_EQ(scheduledTransmissions.getNextEventTime(), 250s);
+
+  scheduledTransmissions.advance(400s);
+  EXPECT_EQ(scheduledTransmissions.size(), 0);
+  EXPECT_EQ(scheduledTransmissions.getNextEventTime(), std::chrono::milliseconds::max());
+}
+
+TEST(Scheduler, RecordingsScannedRange) {
+  ScheduleQueue scheduledTransmissions;
+  const Frequency sampleRate(2000);
+  const Frequency shift(100);
+  const std::vector<FrequencyRange> ranges = {FrequencyRange(4000, 6000), FrequencyRange(6000, 8000), FrequencyRange(8000, 10000)};
+
+  scheduledTransmissions.push({"", "", 100s, 300s, 6500, 100, ""});
+  scheduledTransmissions.push({"", "", 100s, 300s, 7500, 100, ""});
+  scheduledTransmissions.push({"", "", 200s, 300s, 6970, 100, ""});
+
+  {
+    const auto result = Scheduler::getRecordings(150s, scheduledTransmissions, sampleRate, shift, ranges);
+    EXPECT_EQ(result->first, FrequencyRange(6000, 8000));
+    EXPECT_EQ(result->second.size(), 2);
+    EXPECT_EQ(result->second[0].shift(), -500);
+    EXPECT_EQ(result->second[1].shift(), 500);
+  }
+  {
+    // transmission close to dc of scanned range falls back to shifted center
+    ScheduleQueue closeTransmissions;
+    closeTransmissions.push({"", "", 100s, 300s, 6950, 100, ""});
+    const auto result = Scheduler::getRecordings(150s, closeTransmissions, sampleRate, shift, ranges);
+    EXPECT_EQ(result->first, FrequencyRange(6050, 8050));
+    EXPECT_EQ(result->second.size(), 1);
+    EXPECT_EQ(result->second[0].shift(), -100);
+  }
+}
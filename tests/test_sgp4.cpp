@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <radio/local_planner.h>
+#include <utils/sgp4.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// spacetrack report 3 test orbit
+constexpr auto NAME = "TEST";
+constexpr auto LINE1 = "1 88888U          80275.98708465  .00073094  13844-3  66816-4 0     8";
+constexpr auto LINE2 = "2 88888  72.8435 115.9689 0086731  52.6988 110.5714 16.05824518   105";
+
+}  // namespace
+
+TEST(Sgp4, ParseTle) {
+  const auto tles = Tle::parseFile(std::string(NAME) + "\n" + LINE1 + "\n" + LINE2 + "\n");
+  ASSERT_EQ(tles.size(), 1);
+  const auto& tle = tles.at(88888);
+  EXPECT_EQ(tle.name, NAME);
+  EXPECT_NEAR(tle.bstar, 0.66816e-4, 1e-12);
+  EXPECT_NEAR(tle.eccentricity, 0.0086731, 1e-12);
+  // 1980-10-01 23:41:24.1138 utc
+  EXPECT_NEAR(tle.epoch.count(), 339291684113, 1);
+}
+
+TEST(Sgp4, ParseTleSkipsInvalid) {
+  std::string line1 = LINE1;
+  line1.replace(2, 5, "ABCDE");
+  const auto content = std::string("SHORT\n") + LINE1 + "\n2 88888  72.8435\nBAD ID\n" + line1 + "\n" + LINE2 + "\n" + NAME + "\n" + LINE1 + "\n" + LINE2 + "\n";
+  const auto tles = Tle::parseFile(content);
+  ASSERT_EQ(tles.size(), 1);
+  EXPECT_EQ(tles.at(88888).name, NAME);
+}
+
+TEST(Sgp4, Propagate) {
+  const Sgp4 sgp4(Tle::parse(NAME, LINE1, LINE2));
+  const std::vector<std::pair<double, std::array<double, 3>>> expected = {
+      {0.0, {2328.97048951, -5995.22076416, 1719.97067261}},
+      {360.0, {2456.10705566, -6071.93853760, 1222.89727783}},
+      {720.0, {2567.56195068, -6112.50384522, 713.96397400}},
+      {1080.0, {2663.09078980, -6115.48229980, 196.39640427}},
+      {1440.0, {2742.55133057, -6079.67144775, -326.38095856}},
+  };
+  for (const auto& [minutes, position] : expected) {
+    const auto result = sgp4.propagate(minutes);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_NEAR(result[i], position[i], 0.1);
+    }
+  }
+}
+
+TEST(Sgp4, PlanPasses) {
+  const auto tle = Tle::parse(NAME, LINE1, LINE2);
+  const LocalPlanner planner(50.0, 20.0, 200, 10.0);
+  const std::vector<Satellite> satellites = {{88888, "test", 137100000, 40000, "fm"}, {1, "missing", 137100000, 40000, "fm"}};
+  const auto transmissions = planner.plan(satellites, {}, {{tle.id, tle}}, tle.epoch, tle.epoch + 12h);
+  ASSERT_FALSE(transmissions.empty());
+  const Sgp4 sgp4(tle);
+  for (const auto& transmission : transmissions) {
+    EXPECT_EQ(transmission.name, "test");
+    EXPECT_LT(transmission.begin, transmission.end);
+    EXPECT_LT(transmission.end - transmission.begin, 20min);
+    const auto middle = std::chrono::duration_cast<std::chrono::milliseconds>(transmission.begin + (transmission.end - transmission.begin) / 2);
+    EXPECT_LE(10.0, sgp4.getElevation(middle, 50.0, 20.0, 200));
+    EXPECT_GT(10.0, sgp4.getElevation(std::chrono::duration_cast<std::chrono::milliseconds>(transmission.begin) - 2s, 50.0, 20.0, 200));
+  }
+}
+
+TEST(Sgp4, PlanCrontabs) {
+  const LocalPlanner planner(0.0, 0.0, 0, 10.0);
+  const std::vector<Crontab> crontabs = {{"hourly", "0 * * * *", 600s, 100000000, 10000, "fm"}};
+  const auto transmissions = planner.plan({}, crontabs, {}, 3300s, 3h + 300s);
+  ASSERT_EQ(transmissions.size(), 3);
+  EXPECT_EQ(transmissions[0].begin, 3600s);
+  EXPECT_EQ(transmissions[0].end, 4200s);
+  EXPECT_EQ(transmissions[2].begin, 3h);
+}
+
+TEST(Sgp4, RangeRate) {
+  const auto tle = Tle::parse(NAME, LINE1, LINE2);
+  const Sgp4 sgp4(tle);
+  const LocalPlanner planner(50.0, 20.0, 200, 10.0);
+  const auto transmissions = planner.plan({{88888, "test", 137100000, 40000, "fm"}}, {}, {{tle.id, tle}}, tle.epoch, tle.epoch + 12h);
+  ASSERT_FALSE(transmissions.empty());
+  // satellite approaches at pass begin and moves away at pass end, leo range rate is below 8 km/s
+  const auto begin = sgp4.getRangeRate(std::chrono::duration_cast<std::chrono::milliseconds>(transmissions[0].begin), 50.0, 20.0, 200);
+  const auto end = sgp4.getRangeRate(std::chrono::duration_cast<std::chrono::milliseconds>(transmissions[0].end), 50.0, 20.0, 200);
+  EXPECT_LT(-8.0, begin);
+  EXPECT_LT(begin, 0.0);
+  EXPECT_LT(0.0, end);
+  EXPECT_LT(end, 8.0);
+}
@@ -0,0 +1,27 @@
+#include <gtest/gtest.h>
+#include <radio/spectrogram_lease.h>
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+TEST(SpectrogramLease, InactiveWithoutSubscription) {
+  const SpectrogramLease lease(60s);
+  EXPECT_FALSE(lease.isActive(0ms));
+  EXPECT_FALSE(lease.isActive(1000s));
+}
+
+TEST(SpectrogramLease, RenewExtendsLease) {
+  SpectrogramLease lease(60s);
+  EXPECT_TRUE(lease.renew(100s));
+  EXPECT_TRUE(lease.isActive(100s));
+  EXPECT_TRUE(lease.isActive(159s));
+
+  // renew of active lease is not new subscription
+  EXPECT_FALSE(lease.renew(150s));
+  EXPECT_TRUE(lease.isActive(209s));
+  EXPECT_FALSE(lease.isActive(210s));
+
+  EXPECT_TRUE(lease.renew(300s));
+  EXPECT_TRUE(lease.isActive(300s));
+}
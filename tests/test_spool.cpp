@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <network/spool.h>
+
+#include <filesystem>
+#include <fstream>
+
+constexpr auto SEGMENT_SIZE = 1024;
+
+class SpoolTest : public testing::Test {
+ public:
+  SpoolTest() : m_dir((std::filesystem::temp_directory_path() / "auto_sdr_test_spool").string()) { std::filesystem::remove_all(m_dir); }
+  ~SpoolTest() { std::filesystem::remove_all(m_dir); }
+
+  const std::string m_dir;
+};
+
+TEST_F(SpoolTest, PushPop) {
+  Spool spool(m_dir, 10 * SEGMENT_SIZE, SEGMENT_SIZE);
+  EXPECT_TRUE(spool.empty());
+  EXPECT_TRUE(spool.push("topic1", "data1", 1));
+  EXPECT_TRUE(spool.push("topic2", "data2", 2));
+  EXPECT_FALSE(spool.empty());
+
+  std::string topic;
+  std::string data;
+  int qos;
+  EXPECT_TRUE(spool.pop(topic, data, qos));
+  EXPECT_EQ(topic, "topic1");
+  EXPECT_EQ(data, "data1");
+  EXPECT_EQ(qos, 1);
+  EXPECT_TRUE(spool.pop(topic, data, qos));
+  EXPECT_EQ(topic, "topic2");
+  EXPECT_EQ(data, "data2");
+  EXPECT_EQ(qos, 2);
+  EXPECT_FALSE(spool.pop(topic, data, qos));
+  EXPECT_TRUE(spool.empty());
+}
+
+TEST_F(SpoolTest, TooLarge) {
+  Spool spool(m_dir, 10 * SEGMENT_SIZE, SEGMENT_SIZE);
+  EXPECT_FALSE(spool.push("topic", std::string(SEGMENT_SIZE, 'x'), 0));
+  EXPECT_TRUE(spool.empty());
+}
+
+TEST_F(SpoolTest, EvictOldest) {
+  Spool spool(m_dir, 2 * SEGMENT_SIZE, SEGMENT_SIZE);
+  const std::string data(400, 'x');
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_TRUE(spool.push(std::to_string(i), data, 0));
+  }
+  EXPECT_EQ(spool.evictedSegments(), 1);
+
+  std::string topic;
+  std::string value;
+  int qos;
+  std::vector<std::string> topics;
+  while (spool.pop(topic, value, qos)) {
+    topics.push_back(topic);
+  }
+  EXPECT_EQ(topics, std::vector<std::string>({"2", "3", "4", "5"}));
+}
+
+TEST_F(SpoolTest, Restore) {
+  {
+    Spool spool(m_dir, 10 * SEGMENT_SIZE, SEGMENT_SIZE);
+    const std::string data(400, 'x');
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_TRUE(spool.push(std::to_string(i), data, 0));
+    }
+    std::string topic;
+    std::string value;
+    int qos;
+    EXPECT_TRUE(spool.pop(topic, value, qos));
+    EXPECT_EQ(topic, "0");
+  }
+  {
+    Spool spool(m_dir, 10 * SEGMENT_SIZE, SEGMENT_SIZE);
+    std::string topic;
+    std::string value;
+    int qos;
+    std::vector<std::string> topics;
+    while (spool.pop(topic, value, qos)) {
+      topics.push_back(topic);
+    }
+    EXPECT_EQ(topics, std::vector<std::string>({"1", "2", "3"}));
+  }
+}
+
+TEST_F(SpoolTest, SizeBelowTwoSegments) {
+  Spool spool(m_dir, SEGMENT_SIZE, SEGMENT_SIZE);
+  const std::string data(200, 'x');
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(spool.push(std::to_string(i), data, 0));
+  }
+  EXPECT_LE(spool.size(), SEGMENT_SIZE);
+  EXPECT_LT(0, spool.evictedSegments());
+  EXPECT_FALSE(spool.push("topic", std::string(SEGMENT_SIZE / 2, 'x'), 0));
+}
+
+TEST_F(SpoolTest, InvalidRecord) {
+  {
+    Spool spool(m_dir, 10 * SEGMENT_SIZE, SEGMENT_SIZE);
+    EXPECT_TRUE(spool.push("0", std::string(400, 'x'), 0));
+    EXPECT_TRUE(spool.push("1", std::string(400, 'x'), 0));
+    EXPECT_TRUE(spool.push("2", std::string(400, 'x'), 0));
+  }
+  {
+    // damage data size of first record, it points past write offset
+    std::fstream file(m_dir + "/segment_0000000000000000.bin", std::ios::in | std::ios::out | std::ios::binary);
+    const uint32_t dataSize = SEGMENT_SIZE;
+    file.seekp(2 * sizeof(uint64_t) + sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(&dataSize), sizeof(dataSize));
+  }
+  {
+    Spool spool(m_dir, 10 * SEGMENT_SIZE, SEGMENT_SIZE);
+    std::string topic;
+    std::string value;
+    int qos;
+    std::vector<std::string> topics;
+    while (spool.pop(topic, value, qos)) {
+      topics.push_back(topic);
+    }
+    EXPECT_EQ(topics, std::vector<std::string>({"2"}));
+  }
+}
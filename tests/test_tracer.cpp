@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <tracer.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+namespace {
+nlohmann::json dump() {
+  const auto path = (std::filesystem::temp_directory_path() / "test_tracer.json").string();
+  Tracer::dump(path);
+  std::ifstream stream(path);
+  const auto json = nlohmann::json::parse(stream);
+  std::filesystem::remove(path);
+  return json["traceEvents"];
+}
+
+size_t count(const nlohmann::json& events, const std::string& name, const std::string& phase) {
+  return std::count_if(events.begin(), events.end(), [&](const nlohmann::json& event) { return event["name"] == name && event["ph"] == phase; });
+}
+}  // namespace
+
+TEST(Tracer, Events) {
+  Tracer::setEnabled(true);
+  {
+    Tracer::Scope scope("test_scope", "frequency", 100000000);
+  }
+  Tracer::instant("test_instant");
+  std::thread([]() {
+    Tracer::asyncBegin("test_async", 1);
+    Tracer::asyncEnd("test_async", 1);
+  }).join();
+  Tracer::setEnabled(false);
+  Tracer::instant("test_disabled");
+
+  const auto events = dump();
+  EXPECT_EQ(count(events, "test_scope", "X"), 1);
+  EXPECT_EQ(count(events, "test_instant", "i"), 1);
+  EXPECT_EQ(count(events, "test_async", "b"), 1);
+  EXPECT_EQ(count(events, "test_async", "e"), 1);
+  EXPECT_EQ(count(events, "test_disabled", "i"), 0);
+}
+
+TEST(Tracer, ExitedThreadsDropped) {
+  constexpr auto THREADS = 64;
+  Tracer::setEnabled(true);
+  for (int i = 0; i < THREADS; ++i) {
+    std::thread([]() { Tracer::instant("test_exited"); }).join();
+  }
+  Tracer::setEnabled(false);
+
+  const auto events = dump();
+  EXPECT_LT(0, count(events, "test_exited", "i"));
+  EXPECT_LT(count(events, "test_exited", "i"), THREADS);
+}